@@ -5,6 +5,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 #ifdef DEBUG
 #define dbg(format, arg...)         \
@@ -18,12 +22,36 @@
 #endif
 
 
-#define CONFIG_EATFT_WIDTH 800
-#define CONFIG_EATFT_HEIGHT 480
+/*
+ * All CONFIG_EATFT_ values may be overridden per build,
+ * e.g. -DCONFIG_EATFT_OBUF_SIZE=32
+ */
+#ifndef CONFIG_EATFT_WIDTH
+#  define CONFIG_EATFT_WIDTH 800
+#endif
+#ifndef CONFIG_EATFT_HEIGHT
+#  define CONFIG_EATFT_HEIGHT 480
+#endif
+
+#ifndef CONFIG_EATFT_MARGIN_X
+#  define CONFIG_EATFT_MARGIN_X 2
+#endif
+#ifndef CONFIG_EATFT_MARGIN_Y
+#  define CONFIG_EATFT_MARGIN_Y 2
+#endif
 
-#define CONFIG_EATFT_MARGIN_X 2
-#define CONFIG_EATFT_MARGIN_Y 2
-#define CONFIG_EATFT_MAX_WIDGETS 16
+/* buttons, switches, bars and touch areas, touch codes must stay below 0x80 */
+#ifndef CONFIG_EATFT_MAX_WIDGETS
+#  define CONFIG_EATFT_MAX_WIDGETS 16
+#endif
+/* touch and drag areas, each one also occupies a widget slot */
+#ifndef CONFIG_EATFT_MAX_AREAS
+#  define CONFIG_EATFT_MAX_AREAS 4
+#endif
+/* drag areas, each one also occupies an area */
+#ifndef CONFIG_EATFT_MAX_DRAGS
+#  define CONFIG_EATFT_MAX_DRAGS 2
+#endif
 
 #ifdef __AVR__
 #  include <avr/pgmspace.h>
@@ -43,6 +71,9 @@
 #  define DEBUG_ASSERT assert
 #  define memcpy_P memcpy
 #  define strcpy_P strcpy
+#  define strncpy_P strncpy
+#  define strcmp_P strcmp
+#  define pgm_read_byte(p) (*(const uint8_t *)(p))
 #  define PSTR
 #  define PROGMEM
 #endif
@@ -53,8 +84,120 @@
 #endif
 
 
-#define CONFIG_EATFT_OBUF_SIZE 64
-#define CONFIG_EATFT_IBUF_SIZE 32
+#ifndef CONFIG_EATFT_OBUF_SIZE
+#  define CONFIG_EATFT_OBUF_SIZE 64
+#endif
+#ifndef CONFIG_EATFT_IBUF_SIZE
+#  define CONFIG_EATFT_IBUF_SIZE 32
+#endif
+
+#if CONFIG_EATFT_OBUF_SIZE > 255 || CONFIG_EATFT_IBUF_SIZE > 255
+#  error "packet lengths are a single byte on the wire"
+#endif
+#if CONFIG_EATFT_MAX_WIDGETS > 127 || CONFIG_EATFT_MAX_AREAS > 255
+#  error "too many widgets"
+#endif
+#if CONFIG_EATFT_MAX_DRAGS > CONFIG_EATFT_MAX_AREAS
+#  error "every drag area needs an area"
+#endif
+
+/**
+ * Entries of the binary trace ring, power of two up to 256, 0 disables.
+ * Off on AVR where the ring would take 6 bytes of RAM per entry.
+ */
+#ifndef CONFIG_EATFT_TRACE_SIZE
+#  ifdef __AVR__
+#    define CONFIG_EATFT_TRACE_SIZE 0
+#  else
+#    define CONFIG_EATFT_TRACE_SIZE 32
+#  endif
+#endif
+
+/* link defaults used for cost estimates */
+#ifndef CONFIG_EATFT_LINK_BAUD
+#  define CONFIG_EATFT_LINK_BAUD 115200
+#endif
+#ifndef CONFIG_EATFT_ACK_US
+#  define CONFIG_EATFT_ACK_US 500
+#endif
+/**
+ * Pause the display needs between two SPI bytes. The SPI drivers all keep
+ * it, bytes sent back to back overrun the display and cost a NAK.
+ */
+#ifndef CONFIG_EATFT_SPI_BYTE_US
+#  define CONFIG_EATFT_SPI_BYTE_US 10
+#endif
+
+/* samples buffered per chart, must be a power of two */
+#ifndef CONFIG_EATFT_CHART_RING
+#  define CONFIG_EATFT_CHART_RING 256
+#endif
+/* columns cleared ahead of the chart cursor */
+#ifndef CONFIG_EATFT_CHART_BAND
+#  define CONFIG_EATFT_CHART_BAND 8
+#endif
+
+/* pending updates kept by the scheduler */
+#ifndef CONFIG_EATFT_SCHED_SLOTS
+#  define CONFIG_EATFT_SCHED_SLOTS 8
+#endif
+/* bytes the scheduler may save up while idle */
+#ifndef CONFIG_EATFT_SCHED_BURST
+#  define CONFIG_EATFT_SCHED_BURST (2 * CONFIG_EATFT_OBUF_SIZE)
+#endif
+
+/* poll interval range, fast after activity and decaying towards slow */
+#ifndef CONFIG_EATFT_POLL_MIN_US
+#  define CONFIG_EATFT_POLL_MIN_US 10000UL
+#endif
+#ifndef CONFIG_EATFT_POLL_MAX_US
+#  define CONFIG_EATFT_POLL_MAX_US 250000UL
+#endif
+
+/* records buffered in deferred event mode, power of two up to 128, 0 disables */
+#ifndef CONFIG_EATFT_EVENTS
+#  define CONFIG_EATFT_EVENTS 8
+#endif
+/**
+ * Data bytes kept per buffered record. Touch, button and bar records fit,
+ * longer ones such as the version text are cut, flagged and counted.
+ */
+#ifndef CONFIG_EATFT_EVENT_DATA
+#  define CONFIG_EATFT_EVENT_DATA 8
+#endif
+
+/* button rows materialized by a list and the text buffer per row */
+#ifndef CONFIG_EATFT_LIST_ROWS
+#  define CONFIG_EATFT_LIST_ROWS 8
+#endif
+#ifndef CONFIG_EATFT_LIST_TEXT
+#  define CONFIG_EATFT_LIST_TEXT 32
+#endif
+
+/* visible rows of a console and characters per line */
+#ifndef CONFIG_EATFT_CONSOLE_ROWS
+#  define CONFIG_EATFT_CONSOLE_ROWS 12
+#endif
+#ifndef CONFIG_EATFT_CONSOLE_WIDTH
+#  define CONFIG_EATFT_CONSOLE_WIDTH 48
+#endif
+
+/* elements of a screen handled by the navigator, at most 32 */
+#ifndef CONFIG_EATFT_SCREEN_ELEMENTS
+#  define CONFIG_EATFT_SCREEN_ELEMENTS 24
+#endif
+
+/* outstanding queries and how long to wait for their responses */
+#ifndef CONFIG_EATFT_QUERIES
+#  define CONFIG_EATFT_QUERIES 4
+#endif
+#ifndef CONFIG_EATFT_QUERY_TIMEOUT_US
+#  define CONFIG_EATFT_QUERY_TIMEOUT_US 1000000UL
+#endif
+/* polls answered before a query expires when no clock is registered */
+#ifndef CONFIG_EATFT_QUERY_TIMEOUT_POLLS
+#  define CONFIG_EATFT_QUERY_TIMEOUT_POLLS 16
+#endif
 
 #define EATFT_ACK 0x06
 #define EATFT_NAK 0x15
@@ -121,6 +264,89 @@ struct eatft_point {
     uint16_t y;
 };
 
+/* wire cost of commands, see eatft_cost_begin() */
+struct eatft_cost {
+    uint32_t bytes;
+    uint16_t packets;
+    uint32_t usec;
+};
+
+enum eatft_lane {
+    EATFT_LANE_INTERACTIVE,
+    EATFT_LANE_BULK,
+    EATFT_LANES
+};
+
+/* per lane, waits from the first command of a packet to its flush */
+struct eatft_lane_stats {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t wait_max;
+    uint32_t wait_total;
+};
+
+enum eatft_bar_dir {
+    EATFT_BAR_RIGHT = 'R',
+    EATFT_BAR_LEFT = 'L',
+    EATFT_BAR_UP = 'O',
+    EATFT_BAR_DOWN = 'U'
+};
+
+enum eatft_touch_phase {
+    EATFT_TOUCH_UP = 0,
+    EATFT_TOUCH_DOWN,
+    EATFT_TOUCH_MOVE
+};
+
+enum eatft_widget_type {
+    EATFT_WDT_FREE = 0,
+    EATFT_WDT_BUTTON,
+    EATFT_WDT_SWITCH,
+    EATFT_WDT_TOUCH,
+    EATFT_WDT_DRAG,
+    EATFT_WDT_BAR
+};
+
+enum eatft_trace_event {
+    EATFT_TRACE_STATE = 1,      /* arg: new enum eatft_state */
+    EATFT_TRACE_FLUSH,          /* arg: payload length */
+    EATFT_TRACE_POLL,
+    EATFT_TRACE_ACK,
+    EATFT_TRACE_NAK,
+    EATFT_TRACE_RX,             /* arg: frame length */
+    EATFT_TRACE_DISPATCH,       /* arg: record code */
+    EATFT_TRACE_DISPATCHED,     /* arg: record code */
+    EATFT_TRACE_DRIVER,         /* arg: driver specific milestone */
+    EATFT_TRACE_CALLBACK        /* arg: widget slot, after its callback */
+};
+
+struct eatft_trace_entry {
+    uint32_t time;
+    uint8_t event;
+    uint8_t arg;
+} __attribute__ ((packed));
+
+struct eatft_latency {
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+    uint16_t count;
+};
+
+/* latency breakdown decoded from the trace ring, in clock ticks */
+struct eatft_trace_stats {
+    struct eatft_latency flush_to_ack;
+    struct eatft_latency poll_to_rx;
+    struct eatft_latency rx_to_callback;
+    struct eatft_latency touch_to_callback;
+};
+
+#if CONFIG_EATFT_TRACE_SIZE > 0
+#  define eatft_trace(tft, event, arg) eatft_trace_record(tft, event, arg)
+#else
+#  define eatft_trace(tft, event, arg)
+#endif
+
 struct eatft;
 struct eatft_widget;
 
@@ -129,10 +355,68 @@ struct eatft_widget;
 typedef void (*eatft_callback_t)(struct eatft *tft, struct eatft_widget *widget,
                                  bool down);
 
+/* extended callback for drag areas, carries phase and position */
+typedef void (*eatft_touch_callback_t)(struct eatft *tft,
+                                       struct eatft_widget *widget,
+                                       enum eatft_touch_phase phase,
+                                       uint16_t x, uint16_t y);
+
+/**
+ * Called with the response data following the matched argument, or with
+ * data NULL when the query timed out.
+ */
+typedef void (*eatft_query_callback_t)(struct eatft *tft, void *priv,
+                                       const uint8_t *data, uint8_t len);
+
+/* appends the next part of a bulk transfer, false once it is complete */
+typedef bool (*eatft_bulk_t)(struct eatft *tft, void *priv);
+
+/* record received from the display, see eatft_events_defer() */
+struct eatft_event {
+    uint8_t code;
+    uint8_t len;
+    /* data was cut to CONFIG_EATFT_EVENT_DATA bytes */
+    bool truncated;
+    uint8_t data[CONFIG_EATFT_EVENT_DATA];
+};
+
+/* response record code and first data byte, arg < 0 matches any */
+struct eatft_query {
+    uint8_t code;
+    int16_t arg;
+    eatft_query_callback_t fun;
+    void *priv;
+    uint32_t sent;
+    uint8_t polls;
+};
+
 struct eatft_widget {
-    struct eatft_rect rect;
     eatft_callback_t fun;
     void *priv;
+    uint8_t type;
+
+    /* index into the area table for touch areas, last value of bar graphs */
+    uint8_t aux;
+};
+
+/* geometry, only kept for touch and drag areas */
+struct eatft_area {
+    struct eatft_rect rect;
+
+    /* owning widget slot + 1, 0 marks a free entry */
+    uint8_t widget;
+};
+
+/* callback and state, only kept for drag areas */
+struct eatft_drag {
+    eatft_touch_callback_t fun;
+
+    /* latest coalesced move, delivered once per received frame */
+    struct eatft_point pos;
+    bool moved;
+
+    /* area index + 1, 0 marks a free entry */
+    uint8_t area;
 };
 
 
@@ -148,21 +432,221 @@ struct eatft {
     enum eatft_state state;
     enum eatft_state next_state;
 
+    /* adaptive poll schedule, only used with a clock registered */
+    uint32_t poll_min;
+    uint32_t poll_max;
+    uint32_t poll_interval;
+    uint32_t poll_last;
+
+    /* bytes put on the wire including framing */
+    uint32_t tx_bytes;
+
+    /* link parameters, ack_us is updated by drivers measuring it */
+    uint32_t baud;
+    uint16_t ack_us;
+    struct eatft_cost *cost;
+
+#if CONFIG_EATFT_TRACE_SIZE > 0
+    uint8_t trace_head;
+    struct eatft_trace_entry trace[CONFIG_EATFT_TRACE_SIZE];
+#endif
+
     void (*transmit)(struct eatft *tft);
     void (*receive)(struct eatft *tft);
     bool (*ready)(struct eatft *tft);
     void (*user_action)(struct eatft *tft);
+    uint32_t (*clock)(struct eatft *tft);
     void *driver;
     void *user;
 
-    /* widget section */
-    struct eatft_widget widgets[CONFIG_EATFT_MAX_WIDGETS];
+    /* widget section, callbacks get pointers into the aligned slot table */
+    struct eatft_widget widgets[CONFIG_EATFT_MAX_WIDGETS]
+        __attribute__ ((aligned (__alignof__(struct eatft_widget))));
+    struct eatft_area areas[CONFIG_EATFT_MAX_AREAS];
+    struct eatft_drag drags[CONFIG_EATFT_MAX_DRAGS];
+    /* area index + 1 of the touch in progress, 0 for none */
+    uint8_t grab;
     struct eatft_rect window;
+    /* added to button, switch and bar codes, see eatft_code_base() */
+    uint8_t code_base;
+
+#if CONFIG_EATFT_EVENTS > 0
+    /* records waiting for eatft_events_dispatch(), free running indices */
+    bool events_defer;
+    uint8_t events_head;
+    uint8_t events_tail;
+    uint16_t events_dropped;
+    uint16_t events_truncated;
+    struct eatft_event events[CONFIG_EATFT_EVENTS];
+#endif
+
+    /* pending queries, oldest first */
+    uint8_t nqueries;
+    struct eatft_query queries[CONFIG_EATFT_QUERIES];
+
+    /* bulk producer and the lane the packet buffer is filled for */
+    eatft_bulk_t bulk;
+    void *bulk_priv;
+    uint8_t lane;
+    uint8_t lane_last;
+    uint32_t lane_since;
+    struct eatft_lane_stats lanes[EATFT_LANES];
 
 } __attribute__ ((packed));
 
+/**
+ * Strip chart, samples are decimated to one min/max line per pixel column.
+ * Only completed columns are sent, the cursor sweeps from left to right
+ * and clears a narrow band ahead of it instead of redrawing the plot.
+ */
+struct eatft_chart {
+    struct eatft_rect rect;
+    int16_t min;
+    int16_t max;
+    uint16_t decimation;
+
+    /* free running ring indices */
+    uint16_t head;
+    uint16_t tail;
+    uint16_t column;
+    uint16_t dropped;
+
+    /* last sample of the previous column, keeps the trace connected */
+    int16_t last;
+    int16_t ring[CONFIG_EATFT_CHART_RING];
+};
+
+/**
+ * Update scheduler, keeps the latest pending update per key and runs them
+ * by priority (0 is highest) and deadline within a bytes per second budget.
+ */
+typedef void (*eatft_update_t)(struct eatft *tft, void *arg);
+
+struct eatft_update {
+    const void *key;
+    eatft_update_t fun;
+    void *arg;
+    uint32_t submitted;
+    uint32_t deadline;
+    uint8_t priority;
+};
+
+struct eatft_sched {
+    struct eatft *tft;
+    uint32_t rate;
+    int32_t credit;
+    uint32_t last;
+
+    uint16_t superseded;
+    uint16_t rejected;
+
+    struct eatft_update updates[CONFIG_EATFT_SCHED_SLOTS];
+};
+
+/**
+ * Virtual list, items are fetched through a callback and only the visible
+ * rows exist as buttons. Their touch codes are kept while scrolling.
+ */
+struct eatft_list;
+
+typedef void (*eatft_list_item_t)(struct eatft *tft, void *priv,
+                                  uint16_t index, char *text, uint8_t size);
+typedef void (*eatft_list_select_t)(struct eatft *tft,
+                                    struct eatft_list *list, uint16_t index);
+
+struct eatft_list {
+    struct eatft *tft;
+    struct eatft_rect rect;
+    uint8_t row_height;
+    uint8_t rows;
+    enum eatft_align align;
+
+    uint16_t count;
+    uint16_t top;
+
+    eatft_list_item_t item;
+    eatft_list_select_t select;
+    void *priv;
+
+    struct eatft_widget *buttons[CONFIG_EATFT_LIST_ROWS];
+    /* text hash and item of the drawn rows, hash 0 is an empty row */
+    uint32_t hash[CONFIG_EATFT_LIST_ROWS];
+    uint16_t index[CONFIG_EATFT_LIST_ROWS];
+};
+
+/**
+ * Screen element, screens are arrays of them in PROGMEM. Elements equal in
+ * every field, texts compared by content, are shared between screens.
+ */
+enum eatft_element_type {
+    EATFT_EL_FILL = 1,          /* rect filled with fg */
+    EATFT_EL_TEXT,              /* text in font, fg on bg, placed by pos */
+    EATFT_EL_BUTTON,            /* text aligned by pos */
+    EATFT_EL_SWITCH
+};
+
+struct eatft_element {
+    uint8_t type;
+    uint8_t font;
+    uint8_t fg;
+    uint8_t bg;
+    uint8_t pos;
+    struct eatft_rect rect;
+    const char *text;
+    eatft_callback_t fun;
+    void *priv;
+};
+
+#define EATFT_ELEMENTS(elements) \
+    (elements), (sizeof(elements) / sizeof((elements)[0]))
+
+struct eatft_nav {
+    struct eatft *tft;
+    const struct eatft_element *elements;
+    uint8_t count;
+
+    /* widget of each element of the current screen */
+    struct eatft_widget *widgets[CONFIG_EATFT_SCREEN_ELEMENTS];
+};
+
+/**
+ * Log console, lines are kept in a ring on the host and drawn into a rect
+ * at a limited rate. Lines scrolled out before a redraw are never sent.
+ */
+struct eatft_console {
+    struct eatft *tft;
+    struct eatft_rect rect;
+    uint8_t font;
+    uint8_t fg;
+    uint8_t bg;
+    uint8_t line_height;
+    uint8_t rows;
+
+    /* completed lines, free running, and the line being written */
+    uint32_t head;
+    uint8_t len;
+
+    /* end of the lines on screen and lines never shown */
+    uint32_t shown;
+    uint32_t dropped;
+
+    bool dirty;
+    uint32_t interval;
+    uint32_t last;
+
+    /* text hash per drawn row, 0 is an empty row */
+    uint32_t hash[CONFIG_EATFT_CONSOLE_ROWS];
+    char lines[CONFIG_EATFT_CONSOLE_ROWS + 1][CONFIG_EATFT_CONSOLE_WIDTH];
+};
+
 void eatft_register_user_action(struct eatft *tft, void (*action)(struct eatft*));
 
+/**
+ * Registers a free running microsecond clock, used for timing decisions.
+ */
+void eatft_register_clock(struct eatft *tft, uint32_t (*clock)(struct eatft*));
+uint32_t eatft_clock(struct eatft *tft);
+
 /**
  * NOTE:
  * All struct eatft_rect and point_s based interfaces expect structs in PROGMEM.
@@ -174,6 +658,7 @@ void eatft_terminal_enable(struct eatft *tft, bool enable);
 void eatft_color_set(struct eatft *tft, uint8_t fg, uint8_t bg);
 void eatft_touch_enable(struct eatft *tft, uint8_t enable);
 void eatft_touch_beep(struct eatft *tft, bool enable);
+void eatft_touch_draginterval(struct eatft *tft, uint8_t interval);
 
 void eatft_button_setfont(struct eatft *tft, uint8_t font);
 void eatft_button_setfontzoom(struct eatft *tft, uint8_t factor);
@@ -207,6 +692,8 @@ void eatft_switch_set(struct eatft *tft, uint16_t code, bool enable);
 void eatft_radio_group(struct eatft *tft, uint8_t group);
 
 void eatft_button_remove(struct eatft *tft, uint8_t code);
+/* drops the touch definition but leaves the drawing, code 0 for all */
+void eatft_button_undefine(struct eatft *tft, uint8_t code);
 
 void eatft_touch_areai(struct eatft *tft, uint16_t x, uint16_t y,
                        uint16_t width, uint16_t height);
@@ -239,20 +726,154 @@ void eatft_rect_filli(struct eatft *tft, uint16_t x, uint16_t y,
 void eatft_rect_fillr(struct eatft *tft, const struct eatft_rect *rect,
                       uint8_t color);
 
+void eatft_bar_setcolor(struct eatft *tft, uint8_t fg, uint8_t bg,
+                        uint8_t frame);
+void eatft_bar_createi(struct eatft *tft, uint8_t n, enum eatft_bar_dir dir,
+                       uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       uint8_t start, uint8_t end, uint8_t type);
+void eatft_bar_set(struct eatft *tft, uint8_t n, uint8_t value);
+void eatft_bar_touch(struct eatft *tft, uint8_t n);
+void eatft_bar_remove(struct eatft *tft, uint8_t n);
+
 void eatft_setfont(struct eatft *tft, uint8_t font);
 void eatft_setfontcolor(struct eatft *tft, uint8_t fore, uint8_t back);
 
+void eatft_text_draw(struct eatft *tft, uint16_t x, uint16_t y, char align,
+                     const char *text);
 void eatft_text_drawi(struct eatft *tft, uint16_t x, uint16_t y,
                       uint16_t width, uint16_t height, enum eatft_text_pos pos,
                       const char *text);
 void eatft_text_drawr(struct eatft *tft, const struct eatft_rect *rect,
                       enum eatft_text_pos pos, const char *fmt, ...);
 
+/**
+ * Adaptive polling. With a clock registered eatft_process() polls the
+ * display at the minimum interval after touch activity, during drags and
+ * while queries are outstanding, and backs off by half the interval per
+ * idle poll up to the maximum. Pending drawing packets are always sent
+ * before polling. eatft_poll_next() returns how long the caller may sleep,
+ * 0 when there is work to do right away.
+ */
+void eatft_poll_interval(struct eatft *tft, uint32_t min_us, uint32_t max_us);
+void eatft_poll_kick(struct eatft *tft);
+uint32_t eatft_poll_next(struct eatft *tft);
+
+/**
+ * Deferred events. Once enabled the receive path only queues the records
+ * and callbacks run from eatft_events_dispatch(), called by the application
+ * whenever it suits, never from within eatft_process(). Consecutive drag
+ * moves are merged in the queue, records arriving at a full queue are
+ * dropped and counted. Records longer than CONFIG_EATFT_EVENT_DATA are
+ * queued cut and counted as truncated.
+ */
+void eatft_events_defer(struct eatft *tft, bool defer);
+uint8_t eatft_events_dispatch(struct eatft *tft);
+uint8_t eatft_events_pending(const struct eatft *tft);
+uint16_t eatft_events_dropped(const struct eatft *tft);
+uint16_t eatft_events_truncated(const struct eatft *tft);
+/* takes the oldest record without dispatching it, e.g. to forward it */
+bool eatft_events_pop(struct eatft *tft, struct eatft_event *ev);
+
+/**
+ * Queries are sent like any other command and answered through the
+ * display's send buffer, which is read by the regular polls. Responses are
+ * matched by record code and first argument, so several queries can be
+ * outstanding while drawing goes on. Matched records are not passed on to
+ * the widgets. All return ERROR when the query table is full.
+ */
+int eatft_query_expect(struct eatft *tft, uint8_t code, int16_t arg,
+                       eatft_query_callback_t fun, void *priv);
+/* data[0] is 1 when the switch is on */
+int eatft_query_switch(struct eatft *tft, uint8_t code,
+                       eatft_query_callback_t fun, void *priv);
+/*
+ * data[0] is the bar value. A touch bar report of bar n looks the same as
+ * the answer, one that arrives while BS n is pending is taken as the answer
+ * and the widget callback does not run for it.
+ */
+int eatft_query_bar(struct eatft *tft, uint8_t n,
+                    eatft_query_callback_t fun, void *priv);
+/* data is the version text, not terminated */
+int eatft_query_version(struct eatft *tft, eatft_query_callback_t fun,
+                        void *priv);
+uint8_t eatft_query_pending(const struct eatft *tft);
+
+/**
+ * Output lanes. Everything drawn through the API is interactive and goes
+ * out first. A bulk transfer is pulled from fun one packet at a time,
+ * only at packet boundaries with nothing interactive pending and no poll
+ * due, so touch feedback waits for one bulk packet at most. fun appends
+ * up to eatft_bulk_room() bytes of commands, more are sent without giving
+ * way in between.
+ */
+void eatft_bulk_start(struct eatft *tft, eatft_bulk_t fun, void *priv);
+void eatft_bulk_cancel(struct eatft *tft);
+bool eatft_bulk_active(const struct eatft *tft);
+uint8_t eatft_bulk_room(const struct eatft *tft);
+/* copies the counters out, struct eatft is packed */
+void eatft_lane_stats(const struct eatft *tft, enum eatft_lane lane,
+                      struct eatft_lane_stats *stats);
+void eatft_lane_stats_reset(struct eatft *tft);
+
+/**
+ * Font metrics for measuring text before it is sent. The fixed size fonts
+ * are exact, the proportional ones are estimated per character class and
+ * err on the wide side, see eatft_font_exact().
+ */
+uint16_t eatft_font_height(uint8_t font);
+bool eatft_font_exact(uint8_t font);
+uint16_t eatft_font_width(uint8_t font, const char *text);
+uint8_t eatft_font_fit(uint8_t font, const char *text, uint16_t width,
+                       char *buf, uint8_t size);
+uint8_t eatft_font_selecti(uint16_t width, uint16_t height, const char *text);
+uint8_t eatft_font_selectr(const struct eatft_rect *rect, const char *text);
+
+void eatft_chart_init(struct eatft_chart *chart, const struct eatft_rect *rect,
+                      int16_t min, int16_t max, uint16_t decimation);
+void eatft_chart_push(struct eatft_chart *chart, const int16_t *samples,
+                      uint16_t n);
+void eatft_chart_draw(struct eatft *tft, struct eatft_chart *chart);
+void eatft_chart_clear(struct eatft *tft, struct eatft_chart *chart);
+
+/**
+ * Wire cost model.
+ * Between eatft_cost_begin() and eatft_cost_end() packets are counted
+ * instead of transmitted. Widget calls still allocate widgets, use a
+ * scratch struct eatft without driver to measure them.
+ * eatft_link_set() returns ERROR for a zero baud rate.
+ */
+int eatft_link_set(struct eatft *tft, uint32_t baud, uint16_t ack_us);
+uint32_t eatft_cost_time(struct eatft *tft, uint32_t bytes, uint16_t packets);
+void eatft_cost_begin(struct eatft *tft, struct eatft_cost *cost);
+void eatft_cost_end(struct eatft *tft);
+void eatft_cost_screen(struct eatft *tft, void (*render)(struct eatft *tft),
+                       struct eatft_cost *cost);
+
+/**
+ * Binary trace ring, records state transitions, driver milestones and
+ * event dispatches with eatft_clock() timestamps.
+ */
+void eatft_trace_record(struct eatft *tft, uint8_t event, uint8_t arg);
+uint8_t eatft_trace_copy(struct eatft *tft, struct eatft_trace_entry *entries,
+                         uint8_t max);
+void eatft_trace_analyze(struct eatft *tft, struct eatft_trace_stats *stats);
+
+void eatft_sched_init(struct eatft_sched *sched, struct eatft *tft,
+                      uint32_t rate);
+int eatft_sched_submit(struct eatft_sched *sched, const void *key,
+                       uint8_t priority, uint32_t deadline,
+                       eatft_update_t fun, void *arg);
+void eatft_sched_run(struct eatft_sched *sched);
+uint8_t eatft_sched_pending(const struct eatft_sched *sched);
+uint32_t eatft_sched_lag(const struct eatft_sched *sched);
+
 void eatft_init(struct eatft *tft);
 void eatft_process(struct eatft *tft);
 bool eatft_chk_matches(struct eatft *tft);
 
 int eatft_appendf(struct eatft *tft, const char *fmt, ...);
+void eatft_append(struct eatft *tft, const uint8_t *data, uint8_t len);
+void eatft_reserve(struct eatft *tft, uint8_t len);
 void eatft_poll(struct eatft *tft);
 void eatft_flush(struct eatft *tft);
 void eatft_reset_buffer(struct eatft *tft);
@@ -274,7 +895,20 @@ struct eatft_widget *eatft_wdt_touch_creater(
     struct eatft *tft, const struct eatft_rect *rect, eatft_callback_t callback,
     void *priv);
 
+/**
+ * Drag areas report down, move and up together with the touch position.
+ * Moves are coalesced, only the latest position per area is delivered
+ * for each frame received from the display.
+ */
+struct eatft_widget *eatft_wdt_drag_createi(
+    struct eatft *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+    eatft_touch_callback_t callback, void *priv);
+struct eatft_widget *eatft_wdt_drag_creater(
+    struct eatft *tft, const struct eatft_rect *rect,
+    eatft_touch_callback_t callback, void *priv);
+
 void eatft_wdt_free(struct eatft *tft, struct eatft_widget *widget);
+void eatft_code_base(struct eatft *tft, uint8_t base);
 
 /* Button */
 struct eatft_widget *eatft_wdt_button_vcreatei(
@@ -310,4 +944,71 @@ struct eatft_widget *eatft_wdt_switch_createw(
 void eatft_wdt_switch_set(struct eatft *tft, struct eatft_widget *widget,
                           bool enable);
 
+/**
+ * Bar graphs are drawn by the display and updated with a single value byte.
+ * With a callback given the bar is touch adjustable, the callback is called
+ * with down set after the new value has been stored in the widget.
+ */
+struct eatft_widget *eatft_wdt_bar_createi(
+    struct eatft *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+    enum eatft_bar_dir dir, uint8_t start, uint8_t end, uint8_t value,
+    eatft_callback_t callback, void *priv);
+struct eatft_widget *eatft_wdt_bar_creater(
+    struct eatft *tft, const struct eatft_rect *rect, enum eatft_bar_dir dir,
+    uint8_t start, uint8_t end, uint8_t value,
+    eatft_callback_t callback, void *priv);
+struct eatft_widget *eatft_wdt_bar_createw(
+    struct eatft *tft, enum eatft_bar_dir dir, uint8_t start, uint8_t end,
+    uint8_t value, eatft_callback_t callback, void *priv);
+
+void eatft_wdt_bar_set(struct eatft *tft, struct eatft_widget *widget,
+                       uint8_t value);
+uint8_t eatft_wdt_bar_value(const struct eatft_widget *widget);
+
+/**
+ * Screen navigation, eatft_nav_show() keeps the elements the current and
+ * the new screen have in common and only sends the difference in a single
+ * flush. Elements uncovered by removed ones are redrawn.
+ */
+void eatft_nav_init(struct eatft_nav *nav, struct eatft *tft);
+int eatft_nav_show(struct eatft_nav *nav, const struct eatft_element *elements,
+                   uint8_t count);
+struct eatft_widget *eatft_nav_widget(struct eatft_nav *nav, uint8_t index);
+
+/**
+ * Console, rate is the maximum of redraws per second, 0 for no limit.
+ * eatft_console_update() redraws when due and returns true if it did.
+ */
+void eatft_console_initi(struct eatft_console *con, struct eatft *tft,
+                         uint16_t x, uint16_t y, uint16_t width,
+                         uint16_t height, uint8_t font, uint8_t fg, uint8_t bg,
+                         uint8_t rate);
+void eatft_console_initr(struct eatft_console *con, struct eatft *tft,
+                         const struct eatft_rect *rect, uint8_t font,
+                         uint8_t fg, uint8_t bg, uint8_t rate);
+void eatft_console_write(struct eatft_console *con, const char *text);
+bool eatft_console_update(struct eatft_console *con);
+void eatft_console_redraw(struct eatft_console *con);
+void eatft_console_clear(struct eatft_console *con);
+
+/* List */
+int eatft_list_createi(struct eatft_list *list, struct eatft *tft,
+                       uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       uint8_t row_height, uint16_t count,
+                       eatft_list_item_t item, eatft_list_select_t select,
+                       void *priv);
+int eatft_list_creater(struct eatft_list *list, struct eatft *tft,
+                       const struct eatft_rect *rect, uint8_t row_height,
+                       uint16_t count, eatft_list_item_t item,
+                       eatft_list_select_t select, void *priv);
+void eatft_list_scroll(struct eatft_list *list, int16_t rows);
+void eatft_list_set_top(struct eatft_list *list, uint16_t top);
+void eatft_list_set_count(struct eatft_list *list, uint16_t count);
+void eatft_list_refresh(struct eatft_list *list);
+void eatft_list_free(struct eatft_list *list);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif  /* _EATFT_HEADER_ */
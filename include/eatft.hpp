@@ -0,0 +1,445 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_HPP_
+#define _EATFT_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <eatft.h>
+
+/**
+ * Optional C++17 layer on top of the C API.
+ *
+ * Commands are described by types. Command bytes, the packet size and their
+ * share of the checksum are constants, so emitting a command reduces to
+ * storing the arguments into the packet buffer. Text commands stay with the
+ * C API, they need the formatter anyway.
+ */
+namespace eatftpp {
+
+/* argument kinds */
+struct u8 {
+    using type = uint8_t;
+    static constexpr size_t size = 1;
+
+    static constexpr void put(uint8_t *&p, uint8_t &bcc, type v)
+    {
+        *p++ = v;
+        bcc += v;
+    }
+};
+
+struct u16 {
+    using type = uint16_t;
+    static constexpr size_t size = 2;
+
+    /* little endian as %D */
+    static constexpr void put(uint8_t *&p, uint8_t &bcc, type v)
+    {
+        *p++ = uint8_t(v);
+        *p++ = uint8_t(v >> 8);
+        bcc += uint8_t(v) + uint8_t(v >> 8);
+    }
+};
+
+/* constant bytes, the command name and fixed trailing arguments */
+template <uint8_t... B>
+struct bytes {
+    static constexpr size_t size = sizeof...(B);
+    static constexpr uint8_t sum = uint8_t((0 + ... + B));
+
+    static constexpr void put(uint8_t *&p)
+    {
+        ((*p++ = B), ...);
+    }
+};
+
+template <typename Name, typename Tail, typename... Args>
+struct command {
+    /* escape, name, arguments and fixed tail */
+    static constexpr size_t size =
+        1 + Name::size + (0 + ... + Args::size) + Tail::size;
+    static constexpr uint8_t bcc = uint8_t(0x1b + Name::sum + Tail::sum);
+
+    static_assert(size < CONFIG_EATFT_OBUF_SIZE,
+                  "command does not fit into the packet buffer");
+
+    /* bytes of the command as they appear in the packet */
+    static constexpr std::array<uint8_t, size>
+    encode(typename Args::type... args)
+    {
+        std::array<uint8_t, size> out{};
+        uint8_t *p = out.data();
+        uint8_t sum = 0;
+
+        *p++ = 0x1b;
+        Name::put(p);
+        (Args::put(p, sum, args), ...);
+        Tail::put(p);
+
+        return out;
+    }
+
+    static void emit(struct eatft *tft, typename Args::type... args)
+    {
+        uint8_t *p;
+        uint8_t sum = bcc;
+
+        eatft_reserve(tft, size);
+
+        p = tft->obuf + tft->olen;
+        *p++ = 0x1b;
+        Name::put(p);
+        (Args::put(p, sum, args), ...);
+        Tail::put(p);
+
+        tft->olen += size;
+        tft->bcc += sum;
+    }
+};
+
+template <char A, char B, typename... Args>
+using cmd = command<bytes<uint8_t(A), uint8_t(B)>, bytes<>, Args...>;
+
+namespace cmds {
+using clear = cmd<'D', 'L'>;
+using color_set = cmd<'F', 'D', u8, u8>;
+using touch_enable = cmd<'A', 'A', u8>;
+using line_setwidth = cmd<'G', 'Z', u8, u8>;
+using line_draw = cmd<'G', 'D', u16, u16, u16, u16>;
+using rect_draw = cmd<'G', 'R', u16, u16, u16, u16>;
+using rect_clear = cmd<'R', 'L', u16, u16, u16, u16>;
+using rect_fill = cmd<'R', 'F', u16, u16, u16, u16, u8>;
+using frame_setcolor = cmd<'F', 'R', u8, u8, u8>;
+using frame_draw = cmd<'R', 'R', u16, u16, u16, u16>;
+using touch_area = cmd<'A', 'H', u16, u16, u16, u16>;
+using touch_area_remove = command<bytes<'A', 'V'>, bytes<1>, u16, u16>;
+using button_remove = command<bytes<'A', 'L'>, bytes<1>, u8>;
+using switch_set = cmd<'A', 'P', u8, u8>;
+using bar_set = cmd<'B', 'A', u8, u8>;
+using bar_remove = command<bytes<'B', 'D'>, bytes<1>, u8>;
+using setfont = cmd<'Z', 'F', u8>;
+using setfontcolor = cmd<'F', 'Z', u8, u8>;
+}
+
+/* same arguments and bytes as the C functions of the same name */
+inline void clear(struct eatft *tft)
+{
+    cmds::clear::emit(tft);
+}
+
+inline void color_set(struct eatft *tft, uint8_t fg, uint8_t bg)
+{
+    cmds::color_set::emit(tft, fg, bg);
+}
+
+inline void line_setwidth(struct eatft *tft, uint8_t width)
+{
+    cmds::line_setwidth::emit(tft, width, width);
+}
+
+inline void line_draw(struct eatft *tft, uint16_t x1, uint16_t y1,
+                      uint16_t x2, uint16_t y2)
+{
+    cmds::line_draw::emit(tft, x1, y1, x2, y2);
+}
+
+inline void rect_draw(struct eatft *tft, uint16_t x, uint16_t y,
+                      uint16_t width, uint16_t height)
+{
+    cmds::rect_draw::emit(tft, x, y, x + width, y + height);
+}
+
+inline void rect_clear(struct eatft *tft, uint16_t x, uint16_t y,
+                       uint16_t width, uint16_t height)
+{
+    cmds::rect_clear::emit(tft, x, y, x + width, y + height);
+}
+
+inline void rect_fill(struct eatft *tft, uint16_t x, uint16_t y,
+                      uint16_t width, uint16_t height, uint8_t color)
+{
+    cmds::rect_fill::emit(tft, x, y, x + width, y + height, color);
+}
+
+inline void frame_setcolor(struct eatft *tft, uint8_t inner, uint8_t outer,
+                           uint8_t fill)
+{
+    cmds::frame_setcolor::emit(tft, outer, inner, fill);
+}
+
+inline void frame_draw(struct eatft *tft, uint16_t x, uint16_t y,
+                       uint16_t width, uint16_t height)
+{
+    cmds::frame_draw::emit(tft, x, y, x + width, y + height);
+}
+
+inline void switch_set(struct eatft *tft, uint8_t code, bool enable)
+{
+    cmds::switch_set::emit(tft, code, enable);
+}
+
+inline void bar_set(struct eatft *tft, uint8_t n, uint8_t value)
+{
+    cmds::bar_set::emit(tft, n, value);
+}
+
+inline void setfont(struct eatft *tft, uint8_t font)
+{
+    cmds::setfont::emit(tft, font);
+}
+
+inline void setfontcolor(struct eatft *tft, uint8_t fore, uint8_t back)
+{
+    cmds::setfontcolor::emit(tft, fore, back);
+}
+
+/**
+ * Static callback dispatch. The widget's private pointer carries the object,
+ * the member function is bound at compile time:
+ *
+ *     eatftpp::button<&Panel::on_ok>(tft, &rect, this, EATFT_ALIGN_CENTER, "OK");
+ */
+template <auto Fn>
+struct handler;
+
+template <typename T, void (T::*Fn)(struct eatft *, bool)>
+struct handler<Fn> {
+    using object = T;
+
+    static void call(struct eatft *tft, struct eatft_widget *widget, bool down)
+    {
+        (static_cast<T *>(widget->priv)->*Fn)(tft, down);
+    }
+};
+
+template <typename T,
+          void (T::*Fn)(struct eatft *, enum eatft_touch_phase,
+                        uint16_t, uint16_t)>
+struct handler<Fn> {
+    using object = T;
+
+    static void call(struct eatft *tft, struct eatft_widget *widget,
+                     enum eatft_touch_phase phase, uint16_t x, uint16_t y)
+    {
+        (static_cast<T *>(widget->priv)->*Fn)(tft, phase, x, y);
+    }
+};
+
+template <auto Fn>
+inline struct eatft_widget *button(struct eatft *tft,
+                                   const struct eatft_rect *rect,
+                                   typename handler<Fn>::object *obj,
+                                   enum eatft_align align, const char *text)
+{
+    return eatft_wdt_button_creater(tft, rect, handler<Fn>::call, obj, align,
+                                    PSTR("%s"), text);
+}
+
+template <auto Fn>
+inline struct eatft_widget *switch_(struct eatft *tft,
+                                    const struct eatft_rect *rect,
+                                    typename handler<Fn>::object *obj,
+                                    enum eatft_align align, const char *text)
+{
+    return eatft_wdt_switch_creater(tft, rect, handler<Fn>::call, obj, align,
+                                    PSTR("%s"), text);
+}
+
+template <auto Fn>
+inline struct eatft_widget *touch(struct eatft *tft,
+                                  const struct eatft_rect *rect,
+                                  typename handler<Fn>::object *obj)
+{
+    return eatft_wdt_touch_creater(tft, rect, handler<Fn>::call, obj);
+}
+
+template <auto Fn>
+inline struct eatft_widget *drag(struct eatft *tft,
+                                 const struct eatft_rect *rect,
+                                 typename handler<Fn>::object *obj)
+{
+    return eatft_wdt_drag_creater(tft, rect, handler<Fn>::call, obj);
+}
+
+template <auto Fn>
+inline struct eatft_widget *bar(struct eatft *tft,
+                                const struct eatft_rect *rect,
+                                enum eatft_bar_dir dir, uint8_t start,
+                                uint8_t end, uint8_t value,
+                                typename handler<Fn>::object *obj)
+{
+    return eatft_wdt_bar_creater(tft, rect, dir, start, end, value,
+                                 handler<Fn>::call, obj);
+}
+
+/**
+ * Layout helpers, the constexpr counterparts of eatft_layout.h. Tables
+ * computed from them are constants:
+ *
+ *     constexpr auto keys = eatftpp::layout::grid<3, 4>(keypad, 4);
+ */
+namespace layout {
+
+constexpr struct eatft_rect screen()
+{
+    return { 0, 0, CONFIG_EATFT_WIDTH, CONFIG_EATFT_HEIGHT };
+}
+
+constexpr struct eatft_rect inset(struct eatft_rect r, uint16_t m)
+{
+    return { uint16_t(r.x + m), uint16_t(r.y + m),
+             uint16_t(r.width - 2 * m), uint16_t(r.height - 2 * m) };
+}
+
+constexpr uint16_t split_pos(uint16_t size, uint16_t gap, uint16_t total,
+                             uint16_t i)
+{
+    return uint16_t(uint32_t(i) * (size + gap) / total);
+}
+
+constexpr struct eatft_rect split_col(struct eatft_rect r, uint16_t total,
+                                      uint16_t from, uint16_t span,
+                                      uint16_t gap)
+{
+    return { uint16_t(r.x + split_pos(r.width, gap, total, from)), r.y,
+             uint16_t(split_pos(r.width, gap, total, from + span)
+                      - split_pos(r.width, gap, total, from) - gap),
+             r.height };
+}
+
+constexpr struct eatft_rect split_row(struct eatft_rect r, uint16_t total,
+                                      uint16_t from, uint16_t span,
+                                      uint16_t gap)
+{
+    return { r.x, uint16_t(r.y + split_pos(r.height, gap, total, from)),
+             r.width,
+             uint16_t(split_pos(r.height, gap, total, from + span)
+                      - split_pos(r.height, gap, total, from) - gap) };
+}
+
+constexpr struct eatft_rect column(struct eatft_rect r, uint16_t n,
+                                   uint16_t i, uint16_t gap)
+{
+    return split_col(r, n, i, 1, gap);
+}
+
+constexpr struct eatft_rect row(struct eatft_rect r, uint16_t n,
+                                uint16_t i, uint16_t gap)
+{
+    return split_row(r, n, i, 1, gap);
+}
+
+constexpr struct eatft_rect cell(struct eatft_rect r, uint16_t cols,
+                                 uint16_t rows, uint16_t c, uint16_t rw,
+                                 uint16_t gap)
+{
+    return row(column(r, cols, c, gap), rows, rw, gap);
+}
+
+constexpr struct eatft_rect cut_top(struct eatft_rect r, uint16_t size)
+{
+    return { r.x, r.y, r.width, size };
+}
+
+constexpr struct eatft_rect rest_top(struct eatft_rect r, uint16_t size,
+                                     uint16_t gap)
+{
+    return { r.x, uint16_t(r.y + size + gap), r.width,
+             uint16_t(r.height - size - gap) };
+}
+
+constexpr struct eatft_rect cut_left(struct eatft_rect r, uint16_t size)
+{
+    return { r.x, r.y, size, r.height };
+}
+
+constexpr struct eatft_rect rest_left(struct eatft_rect r, uint16_t size,
+                                      uint16_t gap)
+{
+    return { uint16_t(r.x + size + gap), r.y,
+             uint16_t(r.width - size - gap), r.height };
+}
+
+/* cells in row major order */
+template <size_t Cols, size_t Rows>
+constexpr std::array<struct eatft_rect, Cols * Rows>
+grid(struct eatft_rect r, uint16_t gap)
+{
+    std::array<struct eatft_rect, Cols * Rows> out{};
+
+    for (size_t i = 0; i < Cols * Rows; i++)
+        out[i] = cell(r, Cols, Rows, i % Cols, i / Cols, gap);
+
+    return out;
+}
+
+/* columns sized by weight, a flex row */
+template <size_t N>
+constexpr std::array<struct eatft_rect, N>
+flex_cols(struct eatft_rect r, const uint8_t (&weights)[N], uint16_t gap)
+{
+    std::array<struct eatft_rect, N> out{};
+    uint16_t total = 0;
+    uint16_t from = 0;
+
+    for (size_t i = 0; i < N; i++)
+        total += weights[i];
+
+    for (size_t i = 0; i < N; i++) {
+        out[i] = split_col(r, total, from, weights[i], gap);
+        from += weights[i];
+    }
+
+    return out;
+}
+
+template <size_t N>
+constexpr std::array<struct eatft_rect, N>
+flex_rows(struct eatft_rect r, const uint8_t (&weights)[N], uint16_t gap)
+{
+    std::array<struct eatft_rect, N> out{};
+    uint16_t total = 0;
+    uint16_t from = 0;
+
+    for (size_t i = 0; i < N; i++)
+        total += weights[i];
+
+    for (size_t i = 0; i < N; i++) {
+        out[i] = split_row(r, total, from, weights[i], gap);
+        from += weights[i];
+    }
+
+    return out;
+}
+
+} /* namespace layout */
+
+} /* namespace eatftpp */
+
+#endif  /* _EATFT_HPP_ */
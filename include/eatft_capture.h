@@ -0,0 +1,82 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_CAPTURE_H_
+#define _EATFT_CAPTURE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Capture file format:
+ * A header "EATC" followed by the version byte and three reserved bytes.
+ * Each record is the type, the data length, the time since the previous
+ * record in microseconds as LEB128 varint and the data itself.
+ * A NAK record without data marks an ACK timeout, the next TX record is
+ * a retransmission either way.
+ */
+#define EATFT_CAPTURE_MAGIC "EATC"
+#define EATFT_CAPTURE_VERSION 1
+
+enum eatft_capture_type {
+    EATFT_CAPTURE_TX = 1,
+    EATFT_CAPTURE_ACK,
+    EATFT_CAPTURE_NAK,
+    EATFT_CAPTURE_RX
+};
+
+struct eatft_capture {
+    FILE *file;
+    uint32_t time;
+    uint32_t records;
+};
+
+struct eatft_capture_record {
+    uint8_t type;
+    uint8_t len;
+    /* microseconds since the first record */
+    uint32_t time;
+    uint8_t data[256];
+};
+
+int eatft_capture_open(struct eatft_capture *cap, const char *path);
+int eatft_capture_write(struct eatft_capture *cap, uint8_t type, uint32_t time,
+                        const uint8_t *data, uint8_t len);
+
+int eatft_capture_read_open(struct eatft_capture *cap, const char *path);
+int eatft_capture_read(struct eatft_capture *cap,
+                       struct eatft_capture_record *rec);
+
+void eatft_capture_close(struct eatft_capture *cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _EATFT_CAPTURE_H_ */
@@ -0,0 +1,108 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_DISASM_H_
+#define _EATFT_DISASM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Decodes packets as built by eatft_flush() back into commands, using a
+ * signature table of the commands the library sends. Signatures use the
+ * letters of the formatter: c byte, D 16 bit word, s terminated string.
+ */
+#define EATFT_DISASM_ARGS 12
+
+struct eatft_disasm_cmd {
+    char name[3];
+    /* NULL for commands missing from the table */
+    const char *desc;
+    const char *sig;
+
+    /* command bytes starting at the escape */
+    const uint8_t *raw;
+    uint8_t len;
+
+    uint8_t nargs;
+    uint16_t args[EATFT_DISASM_ARGS];
+    const char *text;
+};
+
+struct eatft_disasm_info {
+    uint8_t dc;
+    uint8_t len;
+    bool bcc_ok;
+    uint8_t commands;
+    /* payload bytes left undecoded after an unknown command */
+    uint8_t unknown;
+};
+
+typedef void (*eatft_disasm_fn)(void *priv, const struct eatft_disasm_cmd *cmd);
+
+int eatft_disasm_packet(const uint8_t *pkt, size_t size,
+                        struct eatft_disasm_info *info,
+                        eatft_disasm_fn fn, void *priv);
+int eatft_disasm_format(const struct eatft_disasm_cmd *cmd, char *buf,
+                        size_t size);
+
+/**
+ * Traffic profile, bytes and counts per command. Framing, the DCx, length
+ * and checksum bytes plus the ACK, is accounted separately.
+ */
+#define EATFT_PROFILE_ENTRIES 64
+
+struct eatft_profile_entry {
+    char name[3];
+    uint32_t count;
+    uint32_t bytes;
+};
+
+struct eatft_profile {
+    uint32_t packets;
+    uint32_t framing;
+    uint32_t bytes;
+    uint32_t bad;
+    uint8_t n;
+    struct eatft_profile_entry entries[EATFT_PROFILE_ENTRIES];
+};
+
+void eatft_profile_init(struct eatft_profile *prof);
+void eatft_profile_packet(struct eatft_profile *prof, const uint8_t *pkt,
+                          size_t size);
+void eatft_profile_print(const struct eatft_profile *prof, FILE *out,
+                         uint32_t baud, uint16_t ack_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _EATFT_DISASM_H_ */
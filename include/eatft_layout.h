@@ -0,0 +1,133 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_LAYOUT_H_
+#define _EATFT_LAYOUT_H_
+
+#include <eatft.h>
+
+/**
+ * Compile time layout.
+ *
+ * The macros below work on areas, a bare "x, y, width, height" list, so
+ * they nest and a named area is just a #define. EATFT_RECT() turns an area
+ * into a struct eatft_rect initializer. Everything folds to constants, so
+ * tables can be kept in PROGMEM:
+ *
+ *   #define PANEL   EATFT_INSET(EATFT_SCREEN, 4)
+ *   #define KEYPAD  EATFT_REST_TOP(PANEL, 60, 4)
+ *
+ *   static const struct eatft_rect display PROGMEM =
+ *       EATFT_RECT(EATFT_CUT_TOP(PANEL, 60));
+ *
+ *   static const struct eatft_rect keys[] PROGMEM = {
+ *       EATFT_RECT(EATFT_CELL(KEYPAD, 3, 4, 0, 0, 4)),
+ *       EATFT_RECT(EATFT_CELL(KEYPAD, 3, 4, 1, 0, 4)),
+ *       ...
+ *   };
+ *
+ * Splits distribute the rounding remainder, the parts plus gaps always
+ * cover the whole area.
+ */
+
+#define EATFT_RECT(...) { __VA_ARGS__ }
+
+#define EATFT_AREA(x, y, width, height) (x), (y), (width), (height)
+#define EATFT_SCREEN EATFT_AREA(0, 0, CONFIG_EATFT_WIDTH, CONFIG_EATFT_HEIGHT)
+
+/* margin m on all sides */
+#define EATFT_INSET(...) EATFT_INSET_(__VA_ARGS__)
+#define EATFT_INSET_(x, y, w, h, m)                                     \
+    ((x) + (m)), ((y) + (m)), ((w) - 2 * (m)), ((h) - 2 * (m))
+
+/* offset of weight position i within size s of total weights */
+#define EATFT_SPLIT_POS_(s, gap, total, i)                              \
+    ((i) * ((s) + (gap)) / (total))
+
+/**
+ * Proportional splits: the part starting at weight from spanning span
+ * weights out of total, parts are separated by gap pixels.
+ */
+#define EATFT_SPLIT_COL(...) EATFT_SPLIT_COL_(__VA_ARGS__)
+#define EATFT_SPLIT_COL_(x, y, w, h, total, from, span, gap)            \
+    ((x) + EATFT_SPLIT_POS_(w, gap, total, from)),                      \
+    (y),                                                                \
+    (EATFT_SPLIT_POS_(w, gap, total, (from) + (span))                   \
+     - EATFT_SPLIT_POS_(w, gap, total, from) - (gap)),                  \
+    (h)
+
+#define EATFT_SPLIT_ROW(...) EATFT_SPLIT_ROW_(__VA_ARGS__)
+#define EATFT_SPLIT_ROW_(x, y, w, h, total, from, span, gap)            \
+    (x),                                                                \
+    ((y) + EATFT_SPLIT_POS_(h, gap, total, from)),                      \
+    (w),                                                                \
+    (EATFT_SPLIT_POS_(h, gap, total, (from) + (span))                   \
+     - EATFT_SPLIT_POS_(h, gap, total, from) - (gap))
+
+/* column i of n, row i of n and the cell in column c, row r of a grid */
+#define EATFT_COLUMN(...) EATFT_COLUMN_(__VA_ARGS__)
+#define EATFT_COLUMN_(x, y, w, h, n, i, gap)                            \
+    EATFT_SPLIT_COL_(x, y, w, h, n, i, 1, gap)
+
+#define EATFT_ROW(...) EATFT_ROW_(__VA_ARGS__)
+#define EATFT_ROW_(x, y, w, h, n, i, gap)                               \
+    EATFT_SPLIT_ROW_(x, y, w, h, n, i, 1, gap)
+
+#define EATFT_CELL(...) EATFT_CELL_(__VA_ARGS__)
+#define EATFT_CELL_(x, y, w, h, cols, rows, c, r, gap)                  \
+    EATFT_ROW(EATFT_COLUMN_(x, y, w, h, cols, c, gap), rows, r, gap)
+
+/* fixed size strips cut from an edge and what remains beyond gap */
+#define EATFT_CUT_TOP(...) EATFT_CUT_TOP_(__VA_ARGS__)
+#define EATFT_CUT_TOP_(x, y, w, h, size) (x), (y), (w), (size)
+
+#define EATFT_REST_TOP(...) EATFT_REST_TOP_(__VA_ARGS__)
+#define EATFT_REST_TOP_(x, y, w, h, size, gap)                          \
+    (x), ((y) + (size) + (gap)), (w), ((h) - (size) - (gap))
+
+#define EATFT_CUT_BOTTOM(...) EATFT_CUT_BOTTOM_(__VA_ARGS__)
+#define EATFT_CUT_BOTTOM_(x, y, w, h, size)                             \
+    (x), ((y) + (h) - (size)), (w), (size)
+
+#define EATFT_REST_BOTTOM(...) EATFT_REST_BOTTOM_(__VA_ARGS__)
+#define EATFT_REST_BOTTOM_(x, y, w, h, size, gap)                       \
+    (x), (y), (w), ((h) - (size) - (gap))
+
+#define EATFT_CUT_LEFT(...) EATFT_CUT_LEFT_(__VA_ARGS__)
+#define EATFT_CUT_LEFT_(x, y, w, h, size) (x), (y), (size), (h)
+
+#define EATFT_REST_LEFT(...) EATFT_REST_LEFT_(__VA_ARGS__)
+#define EATFT_REST_LEFT_(x, y, w, h, size, gap)                         \
+    ((x) + (size) + (gap)), (y), ((w) - (size) - (gap)), (h)
+
+#define EATFT_CUT_RIGHT(...) EATFT_CUT_RIGHT_(__VA_ARGS__)
+#define EATFT_CUT_RIGHT_(x, y, w, h, size)                              \
+    ((x) + (w) - (size)), (y), (size), (h)
+
+#define EATFT_REST_RIGHT(...) EATFT_REST_RIGHT_(__VA_ARGS__)
+#define EATFT_REST_RIGHT_(x, y, w, h, size, gap)                        \
+    (x), (y), ((w) - (size) - (gap)), (h)
+
+#endif  /* _EATFT_LAYOUT_H_ */
@@ -0,0 +1,84 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_PUMP_H_
+#define _EATFT_PUMP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <eatft.h>
+
+/* guard time after asserting slave select */
+#define CONFIG_EATFT_PUMP_SELECT_US 10
+/* undocumented pause the display needs before the ACK can be queried */
+#define CONFIG_EATFT_PUMP_ACK_US 10
+
+/**
+ * Portable SPI byte pump driven by transfer complete interrupts.
+ * Bytes are sent back to back, guard delays are only inserted after
+ * slave select and before the ACK read. The pause the display needs
+ * between bytes, CONFIG_EATFT_SPI_BYTE_US, is up to the hardware, e.g.
+ * the SPI clock or a short wait in the interrupt. The hardware is accessed
+ * through the ops, which makes it possible to run the state machine against
+ * a simulated peripheral.
+ */
+struct eatft_pump_ops {
+    void (*select)(void *hw, bool enable);
+    /* starts a transfer, completion calls eatft_pump_complete() */
+    void (*write)(void *hw, uint8_t byte);
+    /* starts a one shot timer, expiry calls eatft_pump_timeout() */
+    void (*delay)(void *hw, uint16_t usec);
+};
+
+enum eatft_pump_state {
+    EATFT_PUMP_READY = 0,
+    EATFT_PUMP_SELECT,
+    EATFT_PUMP_SEND,
+    EATFT_PUMP_WAIT,
+    EATFT_PUMP_ACK,
+    EATFT_PUMP_RECEIVE_SELECT,
+    EATFT_PUMP_RECEIVE_HEADER,
+    EATFT_PUMP_RECEIVE_PAYLOAD
+};
+
+struct eatft_pump {
+    struct eatft *tft;
+    const struct eatft_pump_ops *ops;
+    void *hw;
+
+    volatile uint8_t state;
+    uint8_t *pos;
+    uint8_t len;
+};
+
+void eatft_pump_init(struct eatft_pump *pump, struct eatft *tft,
+                     const struct eatft_pump_ops *ops, void *hw);
+
+/* interrupt entry points */
+void eatft_pump_complete(struct eatft_pump *pump, uint8_t byte);
+void eatft_pump_timeout(struct eatft_pump *pump);
+
+#endif  /* _EATFT_PUMP_H_ */
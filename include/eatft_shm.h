@@ -0,0 +1,122 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_SHM_H_
+#define _EATFT_SHM_H_
+
+#include <stdint.h>
+
+#include <eatft.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Display sharing over POSIX shared memory. eatftd owns the display and
+ * the link, every client encodes with its own struct eatft and submits
+ * whole packets into a ring of its slot. The daemon merges the rings round
+ * robin, one packet per client and turn, into the packets to the display.
+ * Records from the display come back through an event ring per slot,
+ * buttons, switches and bars by their code, everything else to all
+ * clients. Wakeups in both directions are futexes on the shared words.
+ */
+#define EATFT_SHM_NAME "/eatft"
+#define EATFT_SHM_MAGIC 0x53544145
+#define EATFT_SHM_CLIENTS 3
+/* power of two */
+#define EATFT_SHM_RING 4096
+#define EATFT_SHM_EVENTS 32
+
+/**
+ * Codes per client, slot i gets the code base (i + 1) * EATFT_SHM_CODES,
+ * codes below the first base are left to the daemon.
+ */
+#define EATFT_SHM_CODES 32
+
+#if CONFIG_EATFT_MAX_WIDGETS >= EATFT_SHM_CODES
+#  error "widget codes of a client must fit into EATFT_SHM_CODES"
+#endif
+
+struct eatft_shm_event {
+    uint8_t code;
+    uint8_t len;
+    uint8_t data[CONFIG_EATFT_EVENT_DATA];
+};
+
+/* free running indices, each written by one side only */
+struct eatft_shm_client {
+    /* owner process, 0 for a free slot */
+    uint32_t pid;
+
+    /* packets as length and payload, client to daemon */
+    uint32_t cmd_head;
+    uint32_t cmd_tail;
+    /* set by a client waiting for space */
+    uint32_t cmd_waiting;
+
+    /* daemon to client, ev_seq is bumped for every event */
+    uint32_t ev_head;
+    uint32_t ev_tail;
+    uint32_t ev_seq;
+    uint32_t ev_dropped;
+
+    uint8_t ring[EATFT_SHM_RING];
+    struct eatft_shm_event events[EATFT_SHM_EVENTS];
+};
+
+struct eatft_shm {
+    uint32_t magic;
+    /* bumped by clients submitting packets, the daemon sleeps on it */
+    uint32_t seq;
+    /* slot served next by the daemon */
+    uint32_t turn;
+    struct eatft_shm_client clients[EATFT_SHM_CLIENTS];
+};
+
+/**
+ * Client side, a driver like eatft_unix_create(). Polls are answered from
+ * the event ring without reaching the display.
+ */
+int eatft_shm_create(struct eatft *tft, const char *name);
+/* sleeps until events arrive or timeout_us passed */
+void eatft_shm_wait(struct eatft *tft, uint32_t timeout_us);
+int eatft_shm_free(struct eatft *tft);
+
+/* daemon side */
+struct eatft_shm *eatft_shm_server_create(const char *name);
+uint16_t eatft_shm_server_forward(struct eatft_shm *shm, struct eatft *tft,
+                                  uint16_t limit);
+void eatft_shm_server_route(struct eatft_shm *shm, struct eatft *tft);
+void eatft_shm_server_reap(struct eatft_shm *shm, struct eatft *tft);
+void eatft_shm_server_wait(struct eatft_shm *shm, uint32_t seq,
+                           uint32_t timeout_us);
+void eatft_shm_server_free(struct eatft_shm *shm, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _EATFT_SHM_H_ */
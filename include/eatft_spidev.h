@@ -0,0 +1,55 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_SPIDEV_H_
+#define _EATFT_SPIDEV_H_
+
+#include <stdint.h>
+
+#include <eatft.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int (*eatft_spidev_ioctl_t)(int fd, unsigned long request, void *arg);
+
+/* Linux spidev driver, speed in Hz */
+int eatft_spidev_create(struct eatft *tft, const char *dev, uint32_t speed);
+
+/**
+ * Attaches to an opened spidev, fun replaces ioctl(), e.g. with a mock
+ * for tests. NULL uses ioctl().
+ */
+int eatft_spidev_create_fd(struct eatft *tft, int fd, uint32_t speed,
+                           eatft_spidev_ioctl_t fun);
+
+int eatft_spidev_free(struct eatft *tft);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _EATFT_SPIDEV_H_ */
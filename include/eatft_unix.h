@@ -0,0 +1,68 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _EATFT_UNIX_H_
+#define _EATFT_UNIX_H_
+
+#include <stddef.h>
+
+#include <eatft.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* serial port, configured with termios */
+int eatft_unix_create(struct eatft *tft, const char *dev);
+
+/**
+ * Other transports for emulators, serial bridge daemons and test harnesses.
+ * They share the code path of the serial driver but run at memory speed.
+ */
+int eatft_unix_create_fd(struct eatft *tft, int fd);
+/* unix domain stream socket */
+int eatft_unix_connect(struct eatft *tft, const char *path);
+/* the other end is returned in peer */
+int eatft_unix_socketpair(struct eatft *tft, int *peer);
+/* the peer opens the slave returned in name */
+int eatft_unix_openpty(struct eatft *tft, char *name, size_t size);
+
+int eatft_unix_free(struct eatft *tft);
+
+/* monotonic microseconds, shared by all drivers running on UNIX */
+uint32_t eatft_unix_clock(struct eatft *tft);
+
+/**
+ * Logs every transmitted packet, ACK/NAK and received frame with a
+ * monotonic timestamp to a capture file, see eatft_capture.h.
+ * Passing NULL stops capturing.
+ */
+int eatft_unix_capture(struct eatft *tft, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _EATFT_UNIX_H_ */
@@ -30,42 +30,28 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <util/atomic.h>
 #include <util/delay.h>
 
 #include <eatft.h>
 
 #include "eatft_avr.h"
-#include "eatft.h"
-
-
-enum eatft_driver_state {
-    EATFT_DRIVER_READY = 0,
-    EATFT_DRIVER_START,
-    EATFT_DRIVER_SEND,
-    EATFT_DRIVER_WAIT,
-    EATFT_DRIVER_RECEIVE_ACK,
-    EATFT_DRIVER_RECEIVE,
-    EATFT_DRIVER_RECEIVE_HEADER,
-    EATFT_DRIVER_RECEIVE_PAYLOAD
-};
+#include "eatft_pump.h"
 
-struct eatft_spi {
-    struct eatft *tft;
-    enum eatft_driver_state state;
+/* Timer2 runs with F_CPU / 64 */
+#define AVR_TIMER_TICKS(usec) ((long) F_CPU / 64L * (usec) / 1000000L)
 
-    uint8_t *pos;
-    int len;
-};
+/* Timer0 runs freely with F_CPU / 64 as clock for traces and polling */
+#define AVR_CLOCK_TICK_US (64000000L / F_CPU)
 
-volatile struct eatft_spi g_driver;
+#if 64000000L % F_CPU
+#  error "the clock needs F_CPU to divide 64 MHz"
+#endif
 
-static void eatft_driver_ss_enable(bool enable);
-static void eatft_driver_timer_enable(bool enable);
-static void eatft_driver_transmit(struct eatft *tft);
-static void eatft_driver_receive(struct eatft *tft);
-static bool eatft_driver_ready(struct eatft *tft);
+static struct eatft_pump g_pump;
+static volatile uint32_t g_clock;
 
-static void eatft_driver_ss_enable(bool enable)
+static void eatft_driver_ss_enable(void *hw, bool enable)
 {
     if (enable)
         PORTB &= ~0x01;
@@ -73,37 +59,45 @@ static void eatft_driver_ss_enable(bool enable)
         PORTB |= 0x01;
 }
 
-static void eatft_driver_timer_enable(bool enable)
+static void eatft_driver_write(void *hw, uint8_t byte)
 {
-    if (enable) {
-        TIMSK |= (1 << OCIE2);
-    } else {
-        TIMSK &= ~(1 << OCIE2);
-    }
+    SPDR = byte;
 }
 
-static void eatft_driver_transmit(struct eatft *tft)
+static void eatft_driver_delay(void *hw, uint16_t usec)
 {
-    volatile struct eatft_spi *driver = tft->driver;
+    long ticks = AVR_TIMER_TICKS(usec);
 
-    driver->state = EATFT_DRIVER_START;
-    eatft_driver_timer_enable(true);
+    /* one shot, the compare ISR disables itself */
+    OCR2 = ticks > 1 ? ticks - 1 : 0;
+    TCNT2 = 0;
+    TIFR = (1 << OCF2);
+    TIMSK |= (1 << OCIE2);
 }
 
-static void eatft_driver_receive(struct eatft *tft)
+static uint32_t eatft_driver_clock(struct eatft *tft)
 {
-    volatile struct eatft_spi *driver = tft->driver;
+    uint32_t base;
+    uint8_t count;
 
-    driver->state = EATFT_DRIVER_RECEIVE;
-    eatft_driver_timer_enable(true);
-}
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        base = g_clock;
+        count = TCNT0;
 
-static bool eatft_driver_ready(struct eatft *tft)
-{
-    volatile struct eatft_spi *driver = tft->driver;
-    return driver->state == EATFT_DRIVER_READY;
+        /* overflowed, but the interrupt has not run yet */
+        if ((TIFR & (1 << TOV0)) && count < 0x80)
+            base += 256 * AVR_CLOCK_TICK_US;
+    }
+
+    return base + count * AVR_CLOCK_TICK_US;
 }
 
+static const struct eatft_pump_ops g_ops = {
+    .select = eatft_driver_ss_enable,
+    .write = eatft_driver_write,
+    .delay = eatft_driver_delay
+};
+
 void eatft_driver_init(struct eatft *tft)
 {
     DDRE = 0x20;
@@ -111,7 +105,9 @@ void eatft_driver_init(struct eatft *tft)
     PORTB = 0xff;
     DDRB = 0x07;
 
-    SPCR = (1 << CPOL) | (1<<SPE) | (1<<DORD) | (1<<CPHA) | (1<<MSTR) | _BV(SPR0);
+    /* SPI transfer complete interrupt drives the byte pump */
+    SPCR = (1 << CPOL) | (1<<SPE) | (1<<DORD) | (1<<CPHA) | (1<<MSTR)
+        | _BV(SPR0) | (1 << SPIE);
     DDRD |= 0x80;
     PORTD |= 0x80;
     _delay_ms(20);
@@ -119,117 +115,40 @@ void eatft_driver_init(struct eatft *tft)
 
     TCNT2 = 0;
 
-    /* CTC Mode, prescaler 64, reset on overflow */
+    /* CTC Mode, prescaler 64, reset on compare match */
+    /* The timer only runs the guard delays the display needs */
     TCCR2 = (0 << CS22) | (1 << CS21) | (1 << CS20) | (1 << WGM21);
 
-    /* OCR2 = F_CPU / 64 / 5000 - 1 */
-    /* We need a timer to conform to the timing specs */
-    /* Compare Match mit 7.5kHz, */
-    OCR2 = (long) F_CPU / (64L * 10000L) - 1;
-
-    g_driver.tft = tft;
-    g_driver.state = EATFT_DRIVER_READY;
-
-    tft->driver = (void*)&g_driver;
-    tft->transmit = eatft_driver_transmit;
-    tft->receive = eatft_driver_receive;
-    tft->ready = eatft_driver_ready;
+    /* normal mode, prescaler 64, counts the overflows */
+    TCNT0 = 0;
+    TCCR0 = (1 << CS02);
+    TIMSK |= (1 << TOIE0);
 
     eatft_init(tft);
+    eatft_register_clock(tft, eatft_driver_clock);
+    eatft_pump_init(&g_pump, tft, &g_ops, NULL);
 }
 
-ISR(TIMER2_COMP_vect)
+ISR(SPI_STC_vect)
 {
-    volatile struct eatft_spi *driver = &g_driver;
-
-    PORTE ^= 0x20;
-
-    switch (driver->state) {
-
-    case EATFT_DRIVER_START:
-        eatft_driver_ss_enable(true);
-        driver->pos = &driver->tft->dc;
-
-        /* add DCx, len and bcc to len */
-        driver->len = driver->tft->olen + 3;
-
-        driver->state = EATFT_DRIVER_SEND;
-        break;
+    uint8_t byte = SPDR;
 
-    case EATFT_DRIVER_SEND:
-        if (driver->len-- > 0) {
-            SPDR = *driver->pos++;
-        } else {
-            eatft_driver_ss_enable(false);
-            driver->state = EATFT_DRIVER_WAIT;
-        }
+    /* pause before the next byte, shorter than a timer round trip */
+    _delay_us(CONFIG_EATFT_SPI_BYTE_US);
 
-        break;
-
-    case EATFT_DRIVER_WAIT:
-        /**
-         * undocumented wait state.
-         * The display needs ~10us before ACK can be queried.
-         */
-        eatft_driver_ss_enable(true);
-
-        /* trigger SPI for reading ACK */
-        SPDR = 0x00;
-
-        driver->state = EATFT_DRIVER_RECEIVE_ACK;
-        break;
-
-    case EATFT_DRIVER_RECEIVE_ACK:
-        if (SPDR == EATFT_ACK) {
-            driver->state = EATFT_DRIVER_READY;
-        } else {
-            /* NAK or something, try again */
-            eatft_driver_ss_enable(false);
-
-            driver->state = EATFT_DRIVER_START;
-        }
-        break;
-
-    case EATFT_DRIVER_RECEIVE:
-        eatft_driver_ss_enable(true);
-
-        /* DCx and len */
-        driver->len = 2;
-        driver->pos = driver->tft->ibuf;
-        driver->state = EATFT_DRIVER_RECEIVE_HEADER;
-
-        /* trigger SPI */
-        SPDR = 0x00;
-        break;
-
-    case EATFT_DRIVER_RECEIVE_HEADER:
-        *driver->pos++ = SPDR;
-        SPDR = 0x00;
-
-        if (--driver->len <= 0) {
-            driver->len = driver->tft->ibuf[1] + 1;
-            driver->tft->ilen = driver->len + 2;
-            driver->state = EATFT_DRIVER_RECEIVE_PAYLOAD;
-        }
-        break;
-
-    case EATFT_DRIVER_RECEIVE_PAYLOAD:
-        if (driver->len-- > 0) {
-            *driver->pos++ = SPDR;
-
-            if (driver->len > 0)
-                SPDR = 0x00;
-        } else {
-            driver->state = EATFT_DRIVER_READY;
-        }
+    eatft_pump_complete(&g_pump, byte);
+}
 
-        break;
+ISR(TIMER0_OVF_vect)
+{
+    g_clock += 256 * AVR_CLOCK_TICK_US;
+}
 
-    case EATFT_DRIVER_READY:
-        eatft_driver_timer_enable(false);
-        eatft_driver_ss_enable(false);
-        break;
+ISR(TIMER2_COMP_vect)
+{
+    TIMSK &= ~(1 << OCIE2);
 
-    }
+    PORTE ^= 0x20;
 
+    eatft_pump_timeout(&g_pump);
 }
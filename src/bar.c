@@ -0,0 +1,108 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "private.h"
+
+#define CONFIG_EATFT_BAR_HEIGHT 50
+
+/* bar graph pattern, 0 fills the bar */
+#define CONFIG_EATFT_BAR_TYPE 0
+
+struct eatft_widget *eatft_wdt_bar_createi(
+    struct eatft *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+    enum eatft_bar_dir dir, uint8_t start, uint8_t end, uint8_t value,
+    eatft_callback_t callback, void *priv)
+{
+    struct eatft_widget *wdt;
+    uint8_t n;
+
+    wdt = eatft_wdt_alloc(tft, EATFT_WDT_BAR);
+
+    if (wdt) {
+        wdt->fun = callback;
+        wdt->priv = priv;
+        wdt->aux = value;
+
+        /* bar 0 is invalid, so we start from 1 */
+        n = eatft_wdt_code(tft, wdt);
+        eatft_bar_createi(tft, n, dir, x, y, width, height,
+                          start, end, CONFIG_EATFT_BAR_TYPE);
+        eatft_bar_set(tft, n, value);
+        if (callback)
+            eatft_bar_touch(tft, n);
+        eatft_flush(tft);
+    }
+
+    return wdt;
+}
+
+struct eatft_widget *eatft_wdt_bar_creater(
+    struct eatft *tft, const struct eatft_rect *rect, enum eatft_bar_dir dir,
+    uint8_t start, uint8_t end, uint8_t value,
+    eatft_callback_t callback, void *priv)
+{
+    struct eatft_rect r;
+
+    memcpy_P(&r, rect, sizeof(r));
+    return eatft_wdt_bar_createi(tft, r.x, r.y, r.width, r.height,
+                                 dir, start, end, value, callback, priv);
+}
+
+struct eatft_widget *eatft_wdt_bar_createw(
+    struct eatft *tft, enum eatft_bar_dir dir, uint8_t start, uint8_t end,
+    uint8_t value, eatft_callback_t callback, void *priv)
+{
+    struct eatft_widget *wdt;
+
+    tft->window.y += CONFIG_EATFT_MARGIN_Y;
+    wdt = eatft_wdt_bar_createi(
+        tft,
+        tft->window.x, tft->window.y,
+        tft->window.width, CONFIG_EATFT_BAR_HEIGHT,
+        dir, start, end, value, callback, priv);
+    tft->window.y += CONFIG_EATFT_BAR_HEIGHT;
+
+    return wdt;
+}
+
+void eatft_wdt_bar_set(struct eatft *tft, struct eatft_widget *widget,
+                       uint8_t value)
+{
+    /* the display keeps the bar, unchanged values cost nothing */
+    if (widget->aux == value)
+        return;
+
+    widget->aux = value;
+    eatft_bar_set(tft, eatft_wdt_code(tft, widget), value);
+    eatft_flush(tft);
+}
+
+uint8_t eatft_wdt_bar_value(const struct eatft_widget *widget)
+{
+    return widget->aux;
+}
@@ -25,7 +25,8 @@
 
 #include <stdarg.h>
 #include <stdlib.h>
-#include <eatft.h>
+
+#include "private.h"
 
 #define CONFIG_EATFT_BUTTON_HEIGHT 50
 
@@ -34,24 +35,16 @@ struct eatft_widget *eatft_wdt_button_vcreatei(
     eatft_callback_t callback, void *priv, enum eatft_align align,
     const char *fmt, va_list args)
 {
-    struct eatft_widget *wdt = NULL;
+    struct eatft_widget *wdt;
     int i;
 
-    /* search buttons from front to back */
-    for (i = 0; i < CONFIG_EATFT_MAX_WIDGETS; i++) {
-        if (tft->widgets[i].fun == NULL) {
-            wdt = &tft->widgets[i];
-            break;
-        }
-    }
-
-    DEBUG_ASSERT(wdt);
+    wdt = eatft_wdt_alloc(tft, EATFT_WDT_BUTTON);
 
     if (wdt) {
         wdt->fun = callback;
         wdt->priv = priv;
         /* event 0 means disabled, so we start from 1 */
-        i++;
+        i = eatft_wdt_code(tft, wdt);
         eatft_button_vcreatei(tft, x, y, width, height,
                               i | 0x80, i, align, fmt, args);
         eatft_flush(tft);
@@ -0,0 +1,143 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <eatft.h>
+#include <eatft_capture.h>
+
+int eatft_capture_open(struct eatft_capture *cap, const char *path)
+{
+    const uint8_t header[8] = {
+        'E', 'A', 'T', 'C', EATFT_CAPTURE_VERSION, 0, 0, 0
+    };
+
+    cap->time = 0;
+    cap->records = 0;
+    cap->file = fopen(path, "wb");
+
+    if (cap->file == NULL) {
+        perror(path);
+        return ERROR;
+    }
+
+    fwrite(header, sizeof(header), 1, cap->file);
+    return OK;
+}
+
+int eatft_capture_write(struct eatft_capture *cap, uint8_t type, uint32_t time,
+                        const uint8_t *data, uint8_t len)
+{
+    uint8_t buf[2 + 5];
+    uint8_t *p = buf;
+    uint32_t delta;
+
+    /* the first record starts the time line */
+    delta = cap->records++ ? time - cap->time : 0;
+    cap->time = time;
+
+    *p++ = type;
+    *p++ = len;
+    do {
+        *p = delta & 0x7f;
+        delta >>= 7;
+        if (delta)
+            *p |= 0x80;
+        p++;
+    } while (delta);
+
+    if (fwrite(buf, p - buf, 1, cap->file) != 1
+        || (len > 0 && fwrite(data, len, 1, cap->file) != 1)) {
+        return ERROR;
+    }
+
+    return OK;
+}
+
+int eatft_capture_read_open(struct eatft_capture *cap, const char *path)
+{
+    uint8_t header[8];
+
+    cap->time = 0;
+    cap->records = 0;
+    cap->file = fopen(path, "rb");
+
+    if (cap->file == NULL) {
+        perror(path);
+        return ERROR;
+    }
+
+    if (fread(header, sizeof(header), 1, cap->file) != 1
+        || memcmp(header, EATFT_CAPTURE_MAGIC, 4) != 0
+        || header[4] != EATFT_CAPTURE_VERSION) {
+        fprintf(stderr, "ERROR: %s is no capture file\n", path);
+        fclose(cap->file);
+        cap->file = NULL;
+        return ERROR;
+    }
+
+    return OK;
+}
+
+int eatft_capture_read(struct eatft_capture *cap,
+                       struct eatft_capture_record *rec)
+{
+    uint32_t delta = 0;
+    int shift = 0;
+    int c;
+
+    if ((c = fgetc(cap->file)) == EOF)
+        return ERROR;
+    rec->type = c;
+
+    if ((c = fgetc(cap->file)) == EOF)
+        return ERROR;
+    rec->len = c;
+
+    do {
+        if ((c = fgetc(cap->file)) == EOF || shift > 28)
+            return ERROR;
+        delta |= (uint32_t)(c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+
+    if (rec->len > 0 && fread(rec->data, rec->len, 1, cap->file) != 1)
+        return ERROR;
+
+    cap->records++;
+    cap->time += delta;
+    rec->time = cap->time;
+
+    return OK;
+}
+
+void eatft_capture_close(struct eatft_capture *cap)
+{
+    if (cap->file) {
+        fclose(cap->file);
+        cap->file = NULL;
+    }
+}
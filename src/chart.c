@@ -0,0 +1,191 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include "private.h"
+
+#define CHART_MASK (CONFIG_EATFT_CHART_RING - 1)
+
+/* ESC G D x1 y1 x2 y2 */
+#define CHART_LINE_LEN 11
+/* ESC R L x1 y1 x2 y2 */
+#define CHART_CLEAR_LEN 11
+
+#ifdef __SSE2__
+static void eatft_chart_minmax(const int16_t *s, uint16_t n,
+                               int16_t *min, int16_t *max)
+{
+    __m128i vmin = _mm_set1_epi16(*min);
+    __m128i vmax = _mm_set1_epi16(*max);
+    int16_t lane[8];
+    int i;
+
+    for (; n >= 8; n -= 8, s += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)s);
+        vmin = _mm_min_epi16(vmin, v);
+        vmax = _mm_max_epi16(vmax, v);
+    }
+
+    _mm_storeu_si128((__m128i *)lane, vmin);
+    for (i = 0; i < 8; i++)
+        if (lane[i] < *min)
+            *min = lane[i];
+
+    _mm_storeu_si128((__m128i *)lane, vmax);
+    for (i = 0; i < 8; i++)
+        if (lane[i] > *max)
+            *max = lane[i];
+
+    for (; n > 0; n--, s++) {
+        if (*s < *min)
+            *min = *s;
+        if (*s > *max)
+            *max = *s;
+    }
+}
+#else
+static void eatft_chart_minmax(const int16_t *s, uint16_t n,
+                               int16_t *min, int16_t *max)
+{
+    int16_t lo = *min;
+    int16_t hi = *max;
+    int16_t v;
+
+    while (n--) {
+        v = *s++;
+        if (v < lo)
+            lo = v;
+        if (v > hi)
+            hi = v;
+    }
+
+    *min = lo;
+    *max = hi;
+}
+#endif
+
+static uint16_t eatft_chart_scale(const struct eatft_chart *chart, int16_t v)
+{
+    int32_t range = (int32_t)chart->max - chart->min;
+    int32_t h = chart->rect.height - 1;
+
+    if (v < chart->min)
+        v = chart->min;
+    if (v > chart->max)
+        v = chart->max;
+
+    return chart->rect.y + h - ((int32_t)(v - chart->min) * h) / range;
+}
+
+void eatft_chart_init(struct eatft_chart *chart, const struct eatft_rect *rect,
+                      int16_t min, int16_t max, uint16_t decimation)
+{
+    DEBUG_ASSERT(max > min);
+    DEBUG_ASSERT(decimation > 0 && decimation <= CONFIG_EATFT_CHART_RING);
+
+    memset(chart, 0, sizeof(*chart));
+    memcpy_P(&chart->rect, rect, sizeof(chart->rect));
+
+    chart->min = min;
+    chart->max = max;
+    chart->decimation = decimation;
+}
+
+void eatft_chart_push(struct eatft_chart *chart, const int16_t *samples,
+                      uint16_t n)
+{
+    uint16_t used = chart->head - chart->tail;
+
+    /* drop the oldest samples on overrun */
+    if (used + n > CONFIG_EATFT_CHART_RING) {
+        chart->dropped += used + n - CONFIG_EATFT_CHART_RING;
+        chart->tail = chart->head + n - CONFIG_EATFT_CHART_RING;
+    }
+
+    while (n--) {
+        chart->ring[chart->head++ & CHART_MASK] = *samples++;
+    }
+}
+
+void eatft_chart_draw(struct eatft *tft, struct eatft_chart *chart)
+{
+    uint16_t start, first, x, band;
+    int16_t min, max;
+
+    while ((uint16_t)(chart->head - chart->tail) >= chart->decimation) {
+        /* a column may wrap around the end of the ring */
+        start = chart->tail & CHART_MASK;
+
+        /* connect to the previous column, except at the start of a sweep */
+        min = max = chart->column ? chart->last : chart->ring[start];
+
+        first = CONFIG_EATFT_CHART_RING - start;
+        if (first > chart->decimation)
+            first = chart->decimation;
+
+        eatft_chart_minmax(chart->ring + start, first, &min, &max);
+        eatft_chart_minmax(chart->ring, chart->decimation - first, &min, &max);
+
+        chart->tail += chart->decimation;
+        chart->last = chart->ring[(chart->tail - 1) & CHART_MASK];
+
+        x = chart->rect.x + chart->column;
+
+        if (chart->column % CONFIG_EATFT_CHART_BAND == 0) {
+            band = chart->rect.width - chart->column;
+            if (band > CONFIG_EATFT_CHART_BAND)
+                band = CONFIG_EATFT_CHART_BAND;
+
+            eatft_reserve(tft, CHART_CLEAR_LEN);
+            eatft_rect_cleari(tft, x, chart->rect.y,
+                              band - 1, chart->rect.height - 1);
+        }
+
+        eatft_reserve(tft, CHART_LINE_LEN);
+        eatft_line_drawi(tft, x, eatft_chart_scale(chart, max),
+                         x, eatft_chart_scale(chart, min));
+
+        if (++chart->column >= chart->rect.width)
+            chart->column = 0;
+    }
+
+    eatft_flush(tft);
+}
+
+void eatft_chart_clear(struct eatft *tft, struct eatft_chart *chart)
+{
+    eatft_rect_cleari(tft, chart->rect.x, chart->rect.y,
+                      chart->rect.width - 1, chart->rect.height - 1);
+    eatft_flush(tft);
+
+    chart->column = 0;
+    chart->tail = chart->head;
+}
@@ -0,0 +1,185 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "private.h"
+
+#define CONSOLE_SLOTS (CONFIG_EATFT_CONSOLE_ROWS + 1)
+
+static char *eatft_console_line(struct eatft_console *con, uint32_t n)
+{
+    return con->lines[n % CONSOLE_SLOTS];
+}
+
+void eatft_console_initi(struct eatft_console *con, struct eatft *tft,
+                         uint16_t x, uint16_t y, uint16_t width,
+                         uint16_t height, uint8_t font, uint8_t fg, uint8_t bg,
+                         uint8_t rate)
+{
+    memset(con, 0, sizeof(*con));
+    con->tft = tft;
+    con->rect.x = x;
+    con->rect.y = y;
+    con->rect.width = width;
+    con->rect.height = height;
+    con->font = font;
+    con->fg = fg;
+    con->bg = bg;
+    con->interval = rate ? 1000000UL / rate : 0;
+
+    con->line_height = eatft_font_height(font);
+    if (con->line_height == 0)
+        con->line_height = 8;
+
+    con->rows = height / con->line_height;
+    if (con->rows > CONFIG_EATFT_CONSOLE_ROWS)
+        con->rows = CONFIG_EATFT_CONSOLE_ROWS;
+
+    eatft_console_clear(con);
+}
+
+void eatft_console_initr(struct eatft_console *con, struct eatft *tft,
+                         const struct eatft_rect *rect, uint8_t font,
+                         uint8_t fg, uint8_t bg, uint8_t rate)
+{
+    struct eatft_rect r;
+
+    memcpy_P(&r, rect, sizeof(r));
+    eatft_console_initi(con, tft, r.x, r.y, r.width, r.height,
+                        font, fg, bg, rate);
+}
+
+/* appends text, lines end at '\n', overlong lines are cut */
+void eatft_console_write(struct eatft_console *con, const char *text)
+{
+    char *line = eatft_console_line(con, con->head);
+
+    for (; *text; text++) {
+        if (*text == '\n') {
+            con->head++;
+            con->len = 0;
+            line = eatft_console_line(con, con->head);
+            line[0] = '\0';
+        } else if (*text != '\r'
+                   && con->len < CONFIG_EATFT_CONSOLE_WIDTH - 1) {
+            line[con->len++] = *text;
+            line[con->len] = '\0';
+        }
+    }
+
+    con->dirty = true;
+}
+
+/**
+ * Sends the rows whose text differs from what is on the screen. Scrolling
+ * moves every line up a row, unchanged rows are still skipped.
+ */
+void eatft_console_redraw(struct eatft_console *con)
+{
+    struct eatft *tft = con->tft;
+    char text[CONFIG_EATFT_CONSOLE_WIDTH];
+    uint32_t end = con->head + (con->len > 0);
+    uint32_t start = end > con->rows ? end - con->rows : 0;
+    /* fonts without metrics, e.g. loaded ones, can't be fit */
+    bool metrics = eatft_font_height(con->font) != 0;
+    bool styled = false;
+    uint32_t hash;
+    uint16_t y;
+    uint8_t row;
+
+    /* everything before start scrolled out without ever being shown */
+    if (start > con->shown)
+        con->dropped += start - con->shown;
+    con->shown = end;
+
+    for (row = 0; row < con->rows; row++) {
+        y = con->rect.y + row * con->line_height;
+
+        if (start + row < end) {
+            if (metrics) {
+                eatft_font_fit(con->font, eatft_console_line(con, start + row),
+                               con->rect.width, text, sizeof(text));
+            } else {
+                strncpy(text, eatft_console_line(con, start + row),
+                        sizeof(text) - 1);
+                text[sizeof(text) - 1] = '\0';
+            }
+            hash = text[0] ? eatft_text_hash(text) : 0;
+        } else {
+            hash = 0;
+        }
+
+        if (hash == con->hash[row])
+            continue;
+
+        eatft_rect_cleari(tft, con->rect.x, y,
+                          con->rect.width, con->line_height - 1);
+
+        if (hash != 0) {
+            if (!styled) {
+                eatft_setfont(tft, con->font);
+                eatft_setfontcolor(tft, con->fg, con->bg);
+                styled = true;
+            }
+            eatft_text_draw(tft, con->rect.x, y, EATFT_ALIGN_LEFT, text);
+        }
+
+        con->hash[row] = hash;
+    }
+
+    eatft_flush(tft);
+
+    con->dirty = false;
+    con->last = eatft_clock(tft);
+}
+
+bool eatft_console_update(struct eatft_console *con)
+{
+    if (!con->dirty)
+        return false;
+
+    if (con->interval && con->tft->clock
+        && eatft_clock(con->tft) - con->last < con->interval)
+        return false;
+
+    eatft_console_redraw(con);
+    return true;
+}
+
+void eatft_console_clear(struct eatft_console *con)
+{
+    con->head = 0;
+    con->len = 0;
+    con->shown = 0;
+    con->lines[0][0] = '\0';
+    memset(con->hash, 0, sizeof(con->hash));
+
+    eatft_rect_cleari(con->tft, con->rect.x, con->rect.y,
+                      con->rect.width, con->rect.height);
+    eatft_flush(con->tft);
+
+    con->dirty = false;
+}
@@ -0,0 +1,90 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "private.h"
+
+/* start bit, 8 data bits, stop bit */
+#define BITS_PER_BYTE 10
+
+/* the estimates divide by the baud rate, 0 is rejected */
+int eatft_link_set(struct eatft *tft, uint32_t baud, uint16_t ack_us)
+{
+    if (baud == 0)
+        return ERROR;
+
+    tft->baud = baud;
+    tft->ack_us = ack_us;
+
+    return OK;
+}
+
+/* estimated transmit plus ACK time in microseconds */
+uint32_t eatft_cost_time(struct eatft *tft, uint32_t bytes, uint16_t packets)
+{
+    uint64_t usec;
+
+    /* every packet is answered with a single ACK byte */
+    usec = (uint64_t)(bytes + packets) * BITS_PER_BYTE * 1000000 / tft->baud;
+    usec += (uint32_t)packets * tft->ack_us;
+
+    return usec;
+}
+
+void eatft_cost_begin(struct eatft *tft, struct eatft_cost *cost)
+{
+    /* send out what has been buffered so far */
+    eatft_flush(tft);
+    while (tft->state != EATFT_READY) {
+        eatft_process(tft);
+    }
+
+    memset(cost, 0, sizeof(*cost));
+    tft->cost = cost;
+}
+
+void eatft_cost_end(struct eatft *tft)
+{
+    struct eatft_cost *cost = tft->cost;
+
+    if (cost == NULL)
+        return;
+
+    /* count what has not been flushed yet */
+    eatft_flush(tft);
+
+    cost->usec = eatft_cost_time(tft, cost->bytes, cost->packets);
+    tft->cost = NULL;
+}
+
+void eatft_cost_screen(struct eatft *tft, void (*render)(struct eatft *tft),
+                       struct eatft_cost *cost)
+{
+    eatft_cost_begin(tft, cost);
+    render(tft);
+    eatft_cost_end(tft);
+}
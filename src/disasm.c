@@ -0,0 +1,347 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <eatft.h>
+#include <eatft_disasm.h>
+
+struct eatft_signature {
+    char name[3];
+    const char *sig;
+    const char *desc;
+};
+
+/* sorted by name, trailing constants are decoded as byte arguments */
+static const struct eatft_signature signatures[] = {
+    { "AA", "c",        "touch enable" },
+    { "AB", "c",        "bar touch" },
+    { "AE", "cc",       "button frame" },
+    { "AF", "c",        "button font" },
+    { "AH", "DDDD",     "touch area" },
+    { "AI", "c",        "drag interval" },
+    { "AK", "DDDDcccs", "switch" },
+    { "AL", "cc",       "button remove" },
+    { "AO", "cc",       "button offset" },
+    { "AP", "cc",       "switch set" },
+    { "AR", "c",        "radio group" },
+    { "AS", "c",        "touch beep" },
+    { "AT", "DDDDcccs", "button" },
+    { "AV", "DDc",      "touch area remove" },
+    { "AX", "c",        "switch query" },
+    { "AZ", "cc",       "button zoom" },
+    { "BA", "cc",       "bar set" },
+    { "BD", "cc",       "bar remove" },
+    { "BL", "cDDDDccc", "bar" },
+    { "BO", "cDDDDccc", "bar" },
+    { "BR", "cDDDDccc", "bar" },
+    { "BS", "c",        "bar query" },
+    { "BU", "cDDDDccc", "bar" },
+    { "DL", "",         "clear" },
+    { "FA", "cc",       "button font color" },
+    { "FB", "ccc",      "bar color" },
+    { "FD", "cc",       "display color" },
+    { "FE", "cccccc",   "button frame color" },
+    { "FR", "ccc",      "frame color" },
+    { "FZ", "cc",       "font color" },
+    { "GD", "DDDD",     "line" },
+    { "GR", "DDDD",     "rect" },
+    { "GZ", "cc",       "line width" },
+    { "RF", "DDDDc",    "fill" },
+    { "RL", "DDDD",     "clear rect" },
+    { "RR", "DDDD",     "frame" },
+    { "SV", "",         "version query" },
+    { "TA", "",         "terminal off" },
+    { "TE", "",         "terminal on" },
+    { "TI", "",         "terminal info" },
+    { "ZB", "DDDDcs",   "text box" },
+    { "ZC", "DDs",      "text" },
+    { "ZF", "c",        "font" },
+    { "ZL", "DDs",      "text" },
+    { "ZR", "DDs",      "text" },
+};
+
+static const struct eatft_signature poll = { "S", "", "poll" };
+static const struct eatft_signature unknown = { "??", "", "unknown" };
+
+static int eatft_signature_cmp(const void *key, const void *elem)
+{
+    return strcmp(key, ((const struct eatft_signature *)elem)->name);
+}
+
+static const struct eatft_signature *eatft_signature_find(const char *name)
+{
+    const struct eatft_signature *sig;
+
+    if (strcmp(name, poll.name) == 0)
+        return &poll;
+
+    sig = bsearch(name, signatures,
+                  sizeof(signatures) / sizeof(signatures[0]),
+                  sizeof(signatures[0]), eatft_signature_cmp);
+
+    return sig ? sig : &unknown;
+}
+
+/* decodes the arguments, returns the command length or 0 when cut off */
+static uint8_t eatft_disasm_args(struct eatft_disasm_cmd *cmd,
+                                 const uint8_t *p, const uint8_t *end)
+{
+    const uint8_t *start = p;
+    const char *s;
+
+    for (s = cmd->sig; *s; s++) {
+        switch (*s) {
+        case 'c':
+            if (end - p < 1)
+                return 0;
+            cmd->args[cmd->nargs++] = *p++;
+            break;
+        case 'D':
+            if (end - p < 2)
+                return 0;
+            cmd->args[cmd->nargs++] = p[0] | p[1] << 8;
+            p += 2;
+            break;
+        case 's':
+            cmd->text = (const char *)p;
+            while (p < end && *p)
+                p++;
+            if (p == end)
+                return 0;
+            p++;
+            break;
+        }
+    }
+
+    return p - start;
+}
+
+int eatft_disasm_packet(const uint8_t *pkt, size_t size,
+                        struct eatft_disasm_info *info,
+                        eatft_disasm_fn fn, void *priv)
+{
+    struct eatft_disasm_cmd cmd;
+    const struct eatft_signature *sig;
+    const uint8_t *p, *end;
+    uint8_t bcc = 0;
+    uint8_t n;
+    size_t i;
+
+    memset(info, 0, sizeof(*info));
+
+    if (size < 3 || (pkt[0] != EATFT_DC1 && pkt[0] != EATFT_DC2)
+        || size != (size_t)pkt[1] + 3)
+        return ERROR;
+
+    info->dc = pkt[0];
+    info->len = pkt[1];
+
+    for (i = 0; i < size - 1; i++)
+        bcc += pkt[i];
+    info->bcc_ok = bcc == pkt[size - 1];
+
+    p = pkt + 2;
+    end = p + pkt[1];
+
+    while (p < end) {
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.raw = p;
+
+        if (info->dc == EATFT_DC2 && p[0] == 'S') {
+            /* the poll carries no escape */
+            sig = &poll;
+            n = 1;
+        } else if (p[0] == 0x1b && end - p >= 3) {
+            cmd.name[0] = p[1];
+            cmd.name[1] = p[2];
+            sig = eatft_signature_find(cmd.name);
+            if (sig == &unknown || sig == &poll)
+                sig = NULL;
+            n = 3;
+        } else {
+            sig = NULL;
+        }
+
+        if (sig == NULL) {
+            info->unknown = end - p;
+            break;
+        }
+
+        strcpy(cmd.name, sig->name);
+        cmd.desc = sig->desc;
+        cmd.sig = sig->sig;
+
+        if (*sig->sig) {
+            i = eatft_disasm_args(&cmd, p + n, end);
+            if (i == 0) {
+                info->unknown = end - p;
+                break;
+            }
+            n += i;
+        }
+
+        cmd.len = n;
+        info->commands++;
+        if (fn)
+            fn(priv, &cmd);
+
+        p += n;
+    }
+
+    return OK;
+}
+
+int eatft_disasm_format(const struct eatft_disasm_cmd *cmd, char *buf,
+                        size_t size)
+{
+    const char *s;
+    uint8_t arg = 0;
+    int len;
+
+    len = snprintf(buf, size, cmd->sig && *cmd->sig ? "%-2s %-18s" : "%-2s %s",
+                   cmd->name, cmd->desc ? cmd->desc : "?");
+
+    for (s = cmd->sig; s && *s && len < (int)size; s++) {
+        if (*s == 's')
+            len += snprintf(buf + len, size - len, " \"%s\"", cmd->text);
+        else if (*s == 'D')
+            len += snprintf(buf + len, size - len, " %u", cmd->args[arg++]);
+        else
+            len += snprintf(buf + len, size - len, " 0x%02x",
+                            cmd->args[arg++]);
+    }
+
+    return len;
+}
+
+void eatft_profile_init(struct eatft_profile *prof)
+{
+    memset(prof, 0, sizeof(*prof));
+}
+
+static void eatft_profile_cmd(void *priv, const struct eatft_disasm_cmd *cmd)
+{
+    struct eatft_profile *prof = priv;
+    struct eatft_profile_entry *e;
+    uint8_t i;
+
+    for (i = 0; i < prof->n; i++) {
+        if (strcmp(prof->entries[i].name, cmd->name) == 0)
+            break;
+    }
+
+    if (i == prof->n) {
+        if (prof->n == EATFT_PROFILE_ENTRIES)
+            return;
+        prof->n++;
+        strcpy(prof->entries[i].name, cmd->name);
+    }
+
+    e = &prof->entries[i];
+    e->count++;
+    e->bytes += cmd->len;
+}
+
+void eatft_profile_packet(struct eatft_profile *prof, const uint8_t *pkt,
+                          size_t size)
+{
+    struct eatft_disasm_info info;
+
+    if (eatft_disasm_packet(pkt, size, &info, eatft_profile_cmd, prof) != OK
+        || !info.bcc_ok) {
+        prof->bad++;
+        return;
+    }
+
+    prof->packets++;
+    /* DCx, length, checksum and the ACK */
+    prof->framing += 4;
+    prof->bytes += size + 1;
+
+    if (info.unknown) {
+        struct eatft_disasm_cmd cmd;
+
+        /* accounted as a single undecoded chunk */
+        memset(&cmd, 0, sizeof(cmd));
+        strcpy(cmd.name, "??");
+        cmd.len = info.unknown;
+        eatft_profile_cmd(prof, &cmd);
+        prof->bad++;
+    }
+}
+
+static int eatft_profile_order(const void *a, const void *b)
+{
+    const struct eatft_profile_entry *x = a, *y = b;
+
+    return (x->bytes < y->bytes) - (x->bytes > y->bytes);
+}
+
+/* wire time is 10 bits per byte plus the ACK latency per packet */
+void eatft_profile_print(const struct eatft_profile *prof, FILE *out,
+                         uint32_t baud, uint16_t ack_us)
+{
+    struct eatft_profile_entry sorted[EATFT_PROFILE_ENTRIES];
+    const struct eatft_signature *sig;
+    double total, t;
+    uint8_t i;
+
+    /* no link to time, fall back to the default rate */
+    DEBUG_ASSERT(baud > 0);
+    if (baud == 0)
+        baud = CONFIG_EATFT_LINK_BAUD;
+
+    memcpy(sorted, prof->entries, prof->n * sizeof(sorted[0]));
+    qsort(sorted, prof->n, sizeof(sorted[0]), eatft_profile_order);
+
+    total = prof->bytes * 10.0e6 / baud + (double)prof->packets * ack_us;
+    if (total <= 0)
+        total = 1;
+
+    fprintf(out, "%-2s %-18s %8s %10s %10s %6s\n",
+            "", "command", "count", "bytes", "time/ms", "share");
+
+    for (i = 0; i < prof->n; i++) {
+        sig = eatft_signature_find(sorted[i].name);
+        t = sorted[i].bytes * 10.0e6 / baud;
+        fprintf(out, "%-2s %-18s %8u %10u %10.1f %5.1f%%\n",
+                sorted[i].name, sig->desc,
+                sorted[i].count, sorted[i].bytes, t / 1000, 100 * t / total);
+    }
+
+    t = prof->framing * 10.0e6 / baud + (double)prof->packets * ack_us;
+    fprintf(out, "%-2s %-18s %8u %10u %10.1f %5.1f%%\n",
+            "", "framing and ACK", prof->packets, prof->framing,
+            t / 1000, 100 * t / total);
+    fprintf(out, "%-2s %-18s %8s %10u %10.1f\n",
+            "", "total", "", prof->bytes, total / 1000);
+
+    if (prof->bad)
+        fprintf(out, "%u packets with bad framing, checksum or "
+                "unknown commands\n", prof->bad);
+}
@@ -29,7 +29,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <eatft.h>
+#include "private.h"
 
 void eatft_terminal_enable(struct eatft *tft, bool enable)
 {
@@ -46,6 +46,12 @@ void eatft_touch_beep(struct eatft *tft, bool enable)
     eatft_appendf(tft, PSTR("AS%c"), enable);
 }
 
+/* interval between drag reports of free touch areas in 1/100 s */
+void eatft_touch_draginterval(struct eatft *tft, uint8_t interval)
+{
+    eatft_appendf(tft, PSTR("AI%c"), interval);
+}
+
 void eatft_info(struct eatft *tft)
 {
     eatft_appendf(tft, PSTR("T%c"), 'I');
@@ -100,9 +106,23 @@ void eatft_button_vcreatei(struct eatft *tft, uint16_t x, uint16_t y,
                            uint8_t downcode, uint8_t upcode,
                            enum eatft_align align, const char *fmt, va_list args)
 {
-    char text[32];
-    vsprintf(text, fmt, args);
-    eatft_button_createi(tft, x, y, width, height, downcode, upcode, align, text);
+    struct eatft_vaf vaf;
+    va_list text;
+
+    /* the text is formatted straight into the packet */
+    va_copy(text, args);
+    vaf.fmt = fmt;
+    vaf.args = &text;
+
+    eatft_appendf(tft, PSTR("AT%D%D%D%D%c%c%c%V"),
+                  x + CONFIG_EATFT_MARGIN_X,
+                  y + CONFIG_EATFT_MARGIN_Y,
+                  x + width - CONFIG_EATFT_MARGIN_X * 2,
+                  y + height - CONFIG_EATFT_MARGIN_Y * 2,
+                  downcode, upcode,
+                  align,
+                  &vaf);
+    va_end(text);
 }
 
 void eatft_button_setframe(struct eatft *tft, uint8_t n1, uint8_t angle)
@@ -115,6 +135,11 @@ void eatft_button_remove(struct eatft *tft, uint8_t code)
     eatft_appendf(tft, PSTR("AL%c\x01"), code);
 }
 
+void eatft_button_undefine(struct eatft *tft, uint8_t code)
+{
+    eatft_appendf(tft, PSTR("AL%c%c"), code, 0);
+}
+
 void eatft_switch_createi(struct eatft *tft, uint16_t x, uint16_t y,
                           uint16_t width, uint16_t height,
                           uint8_t downcode, uint8_t upcode,
@@ -136,10 +161,22 @@ void eatft_switch_vcreatei(struct eatft *tft, uint16_t x, uint16_t y,
                            enum eatft_align align,
                            const char *fmt, va_list args)
 {
-    char text[32];
-    vsprintf(text, fmt, args);
-    eatft_switch_createi(tft, x, y, width, height, downcode, upcode,
-                         align, text);
+    struct eatft_vaf vaf;
+    va_list text;
+
+    va_copy(text, args);
+    vaf.fmt = fmt;
+    vaf.args = &text;
+
+    eatft_appendf(tft, PSTR("AK%D%D%D%D%c%c%c%V"),
+                  x + CONFIG_EATFT_MARGIN_X,
+                  y + CONFIG_EATFT_MARGIN_Y,
+                  x + width - CONFIG_EATFT_MARGIN_X * 2,
+                  y + height - CONFIG_EATFT_MARGIN_Y * 2,
+                  downcode, upcode,
+                  align,
+                  &vaf);
+    va_end(text);
 }
 
 void eatft_switch_set(struct eatft *tft, uint16_t code, bool enable)
@@ -262,6 +299,40 @@ void eatft_line_drawp(struct eatft *tft, const struct eatft_point *p1,
     eatft_line_drawi(tft, _p1.x, _p1.y, _p2.x, _p2.y);
 }
 
+void eatft_bar_setcolor(struct eatft *tft, uint8_t fg, uint8_t bg,
+                        uint8_t frame)
+{
+    eatft_appendf(tft, PSTR("FB%c%c%c"), fg, bg, frame);
+}
+
+void eatft_bar_createi(struct eatft *tft, uint8_t n, enum eatft_bar_dir dir,
+                       uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       uint8_t start, uint8_t end, uint8_t type)
+{
+    eatft_appendf(tft, PSTR("B%c%c%D%D%D%D%c%c%c"),
+                  dir, n,
+                  x + CONFIG_EATFT_MARGIN_X,
+                  y + CONFIG_EATFT_MARGIN_Y,
+                  x + width - CONFIG_EATFT_MARGIN_X * 2,
+                  y + height - CONFIG_EATFT_MARGIN_Y * 2,
+                  start, end, type);
+}
+
+void eatft_bar_set(struct eatft *tft, uint8_t n, uint8_t value)
+{
+    eatft_appendf(tft, PSTR("BA%c%c"), n, value);
+}
+
+void eatft_bar_touch(struct eatft *tft, uint8_t n)
+{
+    eatft_appendf(tft, PSTR("AB%c"), n);
+}
+
+void eatft_bar_remove(struct eatft *tft, uint8_t n)
+{
+    eatft_appendf(tft, PSTR("BD%c\x01"), n);
+}
+
 void eatft_setfontcolor(struct eatft *tft, uint8_t fore, uint8_t back)
 {
     eatft_appendf(tft, PSTR("FZ%c%c"), fore, back);
@@ -295,21 +366,25 @@ void eatft_text_drawr(struct eatft *tft, const struct eatft_rect *rect,
                       enum eatft_text_pos pos, const char *fmt, ...)
 {
     struct eatft_rect _rect;
+    struct eatft_vaf vaf;
     va_list args;
 
     char fmtbuf[32];
-    char text[32];
 
     strcpy_P(fmtbuf, fmt);
+    memcpy_P(&_rect, rect, sizeof(_rect));
 
     va_start(args, fmt);
-    vsprintf(text, fmtbuf, args);
+    vaf.fmt = fmtbuf;
+    vaf.args = &args;
+
+    eatft_appendf(tft, PSTR("ZB%D%D%D%D%c%V"),
+                  _rect.x + CONFIG_EATFT_MARGIN_X,
+                  _rect.y + CONFIG_EATFT_MARGIN_Y,
+                  _rect.x + _rect.width - CONFIG_EATFT_MARGIN_X * 2,
+                  _rect.y + _rect.height - CONFIG_EATFT_MARGIN_Y * 2,
+                  pos, &vaf);
     va_end(args);
-
-    memcpy_P(&_rect, rect, sizeof(_rect));
-    eatft_text_drawi(tft, _rect.x, _rect.y,
-                     _rect.width, _rect.height,
-                     pos, text);
 }
 
 
@@ -334,9 +409,51 @@ void eatft_register_user_action(struct eatft *tft, void (*action)(struct eatft*)
     tft->user_action = action;
 }
 
+void eatft_register_clock(struct eatft *tft, uint32_t (*clock)(struct eatft*))
+{
+    tft->clock = clock;
+}
+
+uint32_t eatft_clock(struct eatft *tft)
+{
+    return tft->clock ? tft->clock(tft) : 0;
+}
+
 void eatft_init(struct eatft *tft)
 {
     memset(tft->widgets, 0, sizeof(tft->widgets));
+    memset(tft->areas, 0, sizeof(tft->areas));
+    memset(tft->drags, 0, sizeof(tft->drags));
+    tft->grab = 0;
+    /* drivers with a clock register it after init */
+    tft->clock = NULL;
+    tft->code_base = 0;
+    tft->nqueries = 0;
+    tft->poll_min = CONFIG_EATFT_POLL_MIN_US;
+    tft->poll_max = CONFIG_EATFT_POLL_MAX_US;
+    tft->poll_interval = CONFIG_EATFT_POLL_MIN_US;
+    tft->poll_last = 0;
+
+#if CONFIG_EATFT_EVENTS > 0
+    tft->events_defer = false;
+    tft->events_head = 0;
+    tft->events_tail = 0;
+    tft->events_dropped = 0;
+    tft->events_truncated = 0;
+#endif
+    tft->tx_bytes = 0;
+    tft->baud = CONFIG_EATFT_LINK_BAUD;
+    tft->ack_us = CONFIG_EATFT_ACK_US;
+    tft->cost = NULL;
+    tft->bulk = NULL;
+    tft->lane = EATFT_LANE_INTERACTIVE;
+    tft->lane_last = EATFT_LANE_INTERACTIVE;
+    memset(tft->lanes, 0, sizeof(tft->lanes));
+
+#if CONFIG_EATFT_TRACE_SIZE > 0
+    tft->trace_head = 0;
+    memset(tft->trace, 0, sizeof(tft->trace));
+#endif
     eatft_reset_buffer(tft);
     eatft_wdt_window_clear(tft);
 }
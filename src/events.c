@@ -0,0 +1,192 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "private.h"
+
+#if CONFIG_EATFT_EVENTS > 0
+
+#if CONFIG_EATFT_EVENTS & (CONFIG_EATFT_EVENTS - 1)
+#  error "CONFIG_EATFT_EVENTS must be a power of two"
+#endif
+
+#if CONFIG_EATFT_EVENT_DATA < 5
+#  error "touch records need 5 data bytes"
+#endif
+
+#define EVENTS_MASK (CONFIG_EATFT_EVENTS - 1)
+
+static bool eatft_event_is_move(const struct eatft_event *ev)
+{
+    return ev->code == 'H' && ev->len == 5
+        && ev->data[0] == EATFT_TOUCH_MOVE;
+}
+
+void eatft_events_defer(struct eatft *tft, bool defer)
+{
+    tft->events_defer = defer;
+}
+
+bool eatft_events_deferred(const struct eatft *tft)
+{
+    return tft->events_defer;
+}
+
+/* returns true when the record has been taken care of */
+bool eatft_events_push(struct eatft *tft, uint8_t code,
+                       const uint8_t *data, uint8_t len)
+{
+    struct eatft_event *ev;
+    bool truncated = len > CONFIG_EATFT_EVENT_DATA;
+
+    if (!tft->events_defer)
+        return false;
+
+    if (truncated)
+        len = CONFIG_EATFT_EVENT_DATA;
+
+    /* moves in a row are coalesced anyway, keep the latest only */
+    if (tft->events_head != tft->events_tail) {
+        ev = &tft->events[(tft->events_head - 1) & EVENTS_MASK];
+        if (code == 'H' && len == 5 && data[0] == EATFT_TOUCH_MOVE
+            && eatft_event_is_move(ev)) {
+            memcpy(ev->data, data, len);
+            return true;
+        }
+    }
+
+    if ((uint8_t)(tft->events_head - tft->events_tail) == CONFIG_EATFT_EVENTS) {
+        tft->events_dropped++;
+        return true;
+    }
+
+    if (truncated)
+        tft->events_truncated++;
+
+    ev = &tft->events[tft->events_head & EVENTS_MASK];
+    ev->code = code;
+    ev->len = len;
+    ev->truncated = truncated;
+    memcpy(ev->data, data, len);
+    tft->events_head++;
+
+    return true;
+}
+
+/**
+ * Runs the callbacks of the records queued so far, records arriving
+ * meanwhile are left for the next call. Returns the number dispatched.
+ */
+uint8_t eatft_events_dispatch(struct eatft *tft)
+{
+    struct eatft_event ev;
+    uint8_t n = tft->events_head - tft->events_tail;
+    uint8_t i;
+
+    for (i = 0; i < n; i++) {
+        /* callbacks may flush and thereby queue further records */
+        ev = tft->events[tft->events_tail & EVENTS_MASK];
+        tft->events_tail++;
+        eatft_dispatch_record(tft, ev.code, ev.data, ev.len);
+    }
+
+    if (n > 0)
+        eatft_dispatch_end(tft);
+
+    eatft_query_expire(tft);
+
+    return n;
+}
+
+uint8_t eatft_events_pending(const struct eatft *tft)
+{
+    return tft->events_head - tft->events_tail;
+}
+
+uint16_t eatft_events_dropped(const struct eatft *tft)
+{
+    return tft->events_dropped;
+}
+
+uint16_t eatft_events_truncated(const struct eatft *tft)
+{
+    return tft->events_truncated;
+}
+
+bool eatft_events_pop(struct eatft *tft, struct eatft_event *ev)
+{
+    if (tft->events_head == tft->events_tail)
+        return false;
+
+    *ev = tft->events[tft->events_tail & EVENTS_MASK];
+    tft->events_tail++;
+
+    return true;
+}
+
+#else
+
+void eatft_events_defer(struct eatft *tft, bool defer)
+{
+}
+
+bool eatft_events_deferred(const struct eatft *tft)
+{
+    return false;
+}
+
+bool eatft_events_push(struct eatft *tft, uint8_t code,
+                       const uint8_t *data, uint8_t len)
+{
+    return false;
+}
+
+uint8_t eatft_events_dispatch(struct eatft *tft)
+{
+    return 0;
+}
+
+uint8_t eatft_events_pending(const struct eatft *tft)
+{
+    return 0;
+}
+
+uint16_t eatft_events_dropped(const struct eatft *tft)
+{
+    return 0;
+}
+
+uint16_t eatft_events_truncated(const struct eatft *tft)
+{
+    return 0;
+}
+
+bool eatft_events_pop(struct eatft *tft, struct eatft_event *ev)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <eatft.h>
+
+/*
+ * Character classes, the proportional fonts are approximated by one
+ * advance per class.
+ */
+enum {
+    FONT_SPACE = 0,
+    FONT_NARROW,
+    FONT_SEMI,
+    FONT_LOWER,
+    FONT_UPPER,
+    FONT_WIDE,
+    FONT_CLASSES
+};
+
+struct eatft_font_metrics {
+    uint8_t height;
+    bool exact;
+    /* advance including spacing per character class */
+    uint8_t advance[FONT_CLASSES];
+};
+
+/* printable ASCII 0x20..0x7e */
+static const uint8_t font_class[] PROGMEM = {
+    0, 1, 2, 4, 4, 5, 5, 1, 2, 2, 3, 3, 1, 2, 1, 2,  /* 0x20 */
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 1, 1, 3, 3, 3, 3,  /* 0x30 */
+    5, 4, 4, 4, 4, 4, 4, 4, 4, 2, 4, 4, 4, 5, 4, 4,  /* 0x40 */
+    4, 4, 4, 4, 4, 4, 4, 5, 4, 4, 4, 2, 2, 2, 3, 3,  /* 0x50 */
+    1, 3, 3, 3, 3, 3, 2, 3, 3, 1, 2, 3, 1, 5, 3, 3,  /* 0x60 */
+    3, 3, 2, 3, 2, 3, 3, 5, 3, 3, 3, 2, 1, 2, 3,     /* 0x70 */
+};
+
+/*
+ * Indexed by EATFT_FONT_* - 1. The fixed fonts are exact. The advances of
+ * the proportional fonts are estimates rounded up, so measured text is
+ * rather too wide than clipped. The BIGZIF fonts only carry digits.
+ */
+static const struct eatft_font_metrics font_metrics[] PROGMEM = {
+    {   6, true,  {  4,  4,  4,  4,  4,  4 } },     /* 4X6 */
+    {   8, true,  {  6,  6,  6,  6,  6,  6 } },     /* 6X8 */
+    {  12, true,  {  7,  7,  7,  7,  7,  7 } },     /* 7X12 */
+    {  13, false, {  4,  3,  5,  7,  8, 10 } },     /* GENEVA10 */
+    {  16, false, {  5,  4,  6,  8, 10, 13 } },     /* CHICAGO14 */
+    {  32, false, {  9,  7, 11, 16, 20, 27 } },     /* SWISS30 */
+    {  50, false, { 14, 12, 20, 30, 30, 30 } },     /* BIGZIF50 */
+    { 100, false, { 28, 24, 40, 60, 60, 60 } },     /* BIGZIF100 */
+};
+
+#define FONT_COUNT (sizeof(font_metrics) / sizeof(font_metrics[0]))
+
+/* fonts tried by eatft_font_select*(), largest first */
+static const uint8_t font_order[] PROGMEM = {
+    EATFT_FONT_SWISS30,
+    EATFT_FONT_CHICAGO14,
+    EATFT_FONT_GENEVA10,
+    EATFT_FONT_7X12,
+    EATFT_FONT_6X8,
+    EATFT_FONT_4X6
+};
+
+static bool eatft_font_get(uint8_t font, struct eatft_font_metrics *m)
+{
+    if (font < 1 || font > FONT_COUNT)
+        return false;
+
+    memcpy_P(m, &font_metrics[font - 1], sizeof(*m));
+    return true;
+}
+
+static uint8_t eatft_font_advance(const struct eatft_font_metrics *m,
+                                  char c)
+{
+    uint8_t k = (uint8_t)c;
+
+    /* characters beyond ASCII are measured as capitals */
+    if (k < 0x20 || k > 0x7e)
+        return m->advance[FONT_UPPER];
+
+    return m->advance[pgm_read_byte(&font_class[k - 0x20])];
+}
+
+uint16_t eatft_font_height(uint8_t font)
+{
+    struct eatft_font_metrics m;
+
+    return eatft_font_get(font, &m) ? m.height : 0;
+}
+
+bool eatft_font_exact(uint8_t font)
+{
+    struct eatft_font_metrics m;
+
+    return eatft_font_get(font, &m) && m.exact;
+}
+
+uint16_t eatft_font_width(uint8_t font, const char *text)
+{
+    struct eatft_font_metrics m;
+    uint16_t width = 0;
+
+    if (!eatft_font_get(font, &m))
+        return 0;
+
+    while (*text)
+        width += eatft_font_advance(&m, *text++);
+
+    return width;
+}
+
+/**
+ * Copies as much of text into buf as fits into width pixels, text that
+ * had to be cut ends in "...". Returns the length of the result.
+ */
+uint8_t eatft_font_fit(uint8_t font, const char *text, uint16_t width,
+                       char *buf, uint8_t size)
+{
+    struct eatft_font_metrics m;
+    uint16_t used = 0;
+    uint16_t dots;
+    uint8_t n = 0;
+    uint8_t adv;
+
+    if (size == 0)
+        return 0;
+
+    if (!eatft_font_get(font, &m)) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    if (eatft_font_width(font, text) <= width && strlen(text) < size) {
+        strcpy(buf, text);
+        return strlen(buf);
+    }
+
+    dots = 3 * eatft_font_advance(&m, '.');
+
+    while (text[n] && n + 4 < size) {
+        adv = eatft_font_advance(&m, text[n]);
+        if (used + adv + dots > width)
+            break;
+        buf[n] = text[n];
+        used += adv;
+        n++;
+    }
+
+    /* not even the ellipsis fits */
+    if (used + dots > width) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    memcpy(buf + n, "...", 4);
+    return n + 3;
+}
+
+/**
+ * Returns the largest font which fits text into a box as drawn by
+ * eatft_text_drawi(), 0 when none does.
+ */
+uint8_t eatft_font_selecti(uint16_t width, uint16_t height, const char *text)
+{
+    uint16_t w = width - CONFIG_EATFT_MARGIN_X * 3;
+    uint16_t h = height - CONFIG_EATFT_MARGIN_Y * 3;
+    uint8_t font;
+    uint8_t i;
+
+    if (width < CONFIG_EATFT_MARGIN_X * 3 || height < CONFIG_EATFT_MARGIN_Y * 3)
+        return 0;
+
+    for (i = 0; i < sizeof(font_order); i++) {
+        font = pgm_read_byte(&font_order[i]);
+        if (eatft_font_height(font) <= h && eatft_font_width(font, text) <= w)
+            return font;
+    }
+
+    return 0;
+}
+
+uint8_t eatft_font_selectr(const struct eatft_rect *rect, const char *text)
+{
+    struct eatft_rect _rect;
+    memcpy_P(&_rect, rect, sizeof(_rect));
+    return eatft_font_selecti(_rect.width, _rect.height, text);
+}
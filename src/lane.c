@@ -0,0 +1,98 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "private.h"
+
+void eatft_bulk_start(struct eatft *tft, eatft_bulk_t fun, void *priv)
+{
+    tft->bulk = fun;
+    tft->bulk_priv = priv;
+}
+
+/* the packet already handed to the driver still goes out */
+void eatft_bulk_cancel(struct eatft *tft)
+{
+    tft->bulk = NULL;
+}
+
+bool eatft_bulk_active(const struct eatft *tft)
+{
+    return tft->bulk != NULL;
+}
+
+/* bytes of commands, escapes included, that fit into the current packet */
+uint8_t eatft_bulk_room(const struct eatft *tft)
+{
+    return CONFIG_EATFT_OBUF_SIZE - 1 - tft->olen;
+}
+
+/* pulls one packet from the producer, called at a packet boundary */
+void eatft_bulk_fill(struct eatft *tft)
+{
+    eatft_bulk_t fun = tft->bulk;
+
+    tft->lane = EATFT_LANE_BULK;
+
+    if (!fun(tft, tft->bulk_priv) && tft->bulk == fun)
+        tft->bulk = NULL;
+
+    eatft_flush(tft);
+    tft->lane = EATFT_LANE_INTERACTIVE;
+}
+
+/* called for every packet flushed, polls are not counted */
+void eatft_lane_account(struct eatft *tft)
+{
+    struct eatft_lane_stats stats = tft->lanes[tft->lane];
+    uint32_t wait;
+
+    tft->lane_last = tft->lane;
+
+    if (tft->dc != EATFT_DC1 || tft->cost)
+        return;
+
+    wait = eatft_clock(tft) - tft->lane_since;
+
+    stats.packets++;
+    stats.bytes += tft->olen + 3;
+    stats.wait_total += wait;
+    if (wait > stats.wait_max)
+        stats.wait_max = wait;
+
+    tft->lanes[tft->lane] = stats;
+}
+
+void eatft_lane_stats(const struct eatft *tft, enum eatft_lane lane,
+                      struct eatft_lane_stats *stats)
+{
+    *stats = tft->lanes[lane];
+}
+
+void eatft_lane_stats_reset(struct eatft *tft)
+{
+    memset(tft->lanes, 0, sizeof(tft->lanes));
+}
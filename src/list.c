@@ -0,0 +1,217 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "private.h"
+
+/* FNV-1a, 0 is reserved for empty rows */
+uint32_t eatft_text_hash(const char *text)
+{
+    uint32_t h = 2166136261UL;
+
+    while (*text) {
+        h ^= (uint8_t)*text++;
+        h *= 16777619UL;
+    }
+
+    return h ? h : 1;
+}
+
+static void eatft_list_clicked(struct eatft *tft, struct eatft_widget *widget,
+                               bool down)
+{
+    struct eatft_list *list = widget->priv;
+    uint16_t index;
+    uint8_t row;
+
+    if (!down || list->select == NULL)
+        return;
+
+    for (row = 0; row < list->rows; row++) {
+        if (list->buttons[row] == widget)
+            break;
+    }
+
+    index = list->top + row;
+    if (row < list->rows && index < list->count)
+        list->select(tft, list, index);
+}
+
+/**
+ * Fetches the visible items and redraws the rows whose text differs from
+ * what is on the screen, all in as few packets as fit.
+ */
+void eatft_list_refresh(struct eatft_list *list)
+{
+    struct eatft *tft = list->tft;
+    char text[CONFIG_EATFT_LIST_TEXT];
+    uint16_t index;
+    uint32_t hash;
+    uint16_t y;
+    uint8_t code;
+    uint8_t row;
+
+    for (row = 0; row < list->rows; row++) {
+        index = list->top + row;
+        code = eatft_wdt_code(tft, list->buttons[row]);
+        y = list->rect.y + row * list->row_height;
+
+        if (index >= list->count) {
+            if (list->hash[row] != 0) {
+                eatft_button_remove(tft, code);
+                list->hash[row] = 0;
+            }
+            continue;
+        }
+
+        text[0] = '\0';
+        list->item(tft, list->priv, index, text, sizeof(text));
+        text[sizeof(text) - 1] = '\0';
+
+        /* a row only counts as unchanged for the same item */
+        hash = eatft_text_hash(text);
+        if (hash == list->hash[row] && index == list->index[row])
+            continue;
+
+        /* the new button is drawn over the old one, no need to clear */
+        if (list->hash[row] != 0)
+            eatft_button_undefine(tft, code);
+
+        eatft_button_createi(tft, list->rect.x, y,
+                             list->rect.width, list->row_height,
+                             code | 0x80, code, list->align, text);
+        list->hash[row] = hash;
+        list->index[row] = index;
+    }
+
+    eatft_flush(tft);
+}
+
+int eatft_list_createi(struct eatft_list *list, struct eatft *tft,
+                       uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       uint8_t row_height, uint16_t count,
+                       eatft_list_item_t item, eatft_list_select_t select,
+                       void *priv)
+{
+    struct eatft_widget *wdt;
+    uint8_t row;
+
+    memset(list, 0, sizeof(*list));
+    list->tft = tft;
+    list->rect.x = x;
+    list->rect.y = y;
+    list->rect.width = width;
+    list->rect.height = height;
+    list->row_height = row_height;
+    list->align = EATFT_ALIGN_LEFT;
+    list->count = count;
+    list->item = item;
+    list->select = select;
+    list->priv = priv;
+
+    list->rows = height / row_height;
+    if (list->rows > CONFIG_EATFT_LIST_ROWS)
+        list->rows = CONFIG_EATFT_LIST_ROWS;
+
+    /* the slots are kept until the list is freed, so are their codes */
+    for (row = 0; row < list->rows; row++) {
+        wdt = eatft_wdt_alloc(tft, EATFT_WDT_BUTTON);
+        if (wdt == NULL) {
+            list->rows = row;
+            eatft_list_free(list);
+            return ERROR;
+        }
+
+        wdt->fun = eatft_list_clicked;
+        wdt->priv = list;
+        list->buttons[row] = wdt;
+    }
+
+    eatft_list_refresh(list);
+
+    return OK;
+}
+
+int eatft_list_creater(struct eatft_list *list, struct eatft *tft,
+                       const struct eatft_rect *rect, uint8_t row_height,
+                       uint16_t count, eatft_list_item_t item,
+                       eatft_list_select_t select, void *priv)
+{
+    struct eatft_rect r;
+
+    memcpy_P(&r, rect, sizeof(r));
+    return eatft_list_createi(list, tft, r.x, r.y, r.width, r.height,
+                              row_height, count, item, select, priv);
+}
+
+void eatft_list_set_top(struct eatft_list *list, uint16_t top)
+{
+    uint16_t max = list->count > list->rows ? list->count - list->rows : 0;
+
+    if (top > max)
+        top = max;
+
+    if (top == list->top)
+        return;
+
+    list->top = top;
+    eatft_list_refresh(list);
+}
+
+void eatft_list_scroll(struct eatft_list *list, int16_t rows)
+{
+    int32_t top = (int32_t)list->top + rows;
+
+    eatft_list_set_top(list, top < 0 ? 0 : top);
+}
+
+/* also call after items changed, only rows with new texts are sent */
+void eatft_list_set_count(struct eatft_list *list, uint16_t count)
+{
+    uint16_t max = count > list->rows ? count - list->rows : 0;
+
+    list->count = count;
+    if (list->top > max)
+        list->top = max;
+
+    eatft_list_refresh(list);
+}
+
+void eatft_list_free(struct eatft_list *list)
+{
+    struct eatft *tft = list->tft;
+    uint8_t row;
+
+    for (row = 0; row < list->rows; row++) {
+        /* rows never drawn only need their slot back */
+        if (list->hash[row] == 0)
+            memset(list->buttons[row], 0, sizeof(*list->buttons[row]));
+        else
+            eatft_wdt_free(tft, list->buttons[row]);
+    }
+
+    list->rows = 0;
+}
@@ -26,8 +26,33 @@
 #ifndef _EATFT_PRIVATE_H_
 #define _EATFT_PRIVATE_H_
 
+#include <stdarg.h>
+
 #include <eatft.h>
 
+/* formatted text embedded into a command with %V */
+struct eatft_vaf {
+    const char *fmt;
+    va_list *args;
+};
+
 void eatft_dispatch_event(struct eatft *tft);
+void eatft_dispatch_record(struct eatft *tft, uint8_t code,
+                           const uint8_t *data, uint8_t len);
+void eatft_dispatch_end(struct eatft *tft);
+bool eatft_events_deferred(const struct eatft *tft);
+bool eatft_events_push(struct eatft *tft, uint8_t code,
+                       const uint8_t *data, uint8_t len);
+struct eatft_widget *eatft_wdt_alloc(struct eatft *tft, uint8_t type);
+void eatft_wdt_release(struct eatft *tft, struct eatft_widget *widget);
+uint8_t eatft_wdt_code(const struct eatft *tft,
+                       const struct eatft_widget *widget);
+uint32_t eatft_text_hash(const char *text);
+bool eatft_query_dispatch(struct eatft *tft, uint8_t code,
+                          const uint8_t *data, uint8_t len);
+void eatft_query_polled(struct eatft *tft);
+void eatft_query_expire(struct eatft *tft);
+void eatft_bulk_fill(struct eatft *tft);
+void eatft_lane_account(struct eatft *tft);
 
 #endif	/* _EATFT_PRIVATE_H_ */
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "private.h"
 
@@ -51,12 +52,66 @@ bool eatft_chk_matches(struct eatft *tft)
     return chk == tft->ibuf[i];
 }
 
+void eatft_poll_interval(struct eatft *tft, uint32_t min_us, uint32_t max_us)
+{
+    tft->poll_min = min_us;
+    tft->poll_max = max_us;
+    tft->poll_interval = min_us;
+}
+
+/* the application expects input soon */
+void eatft_poll_kick(struct eatft *tft)
+{
+    tft->poll_interval = tft->poll_min;
+}
+
+/**
+ * Without a clock the display is polled whenever the link is idle, taking
+ * turns with the packets of a bulk transfer.
+ */
+static bool eatft_poll_due(struct eatft *tft)
+{
+    if (tft->clock == NULL)
+        return tft->bulk == NULL || tft->lane_last == EATFT_LANE_BULK;
+
+    return eatft_clock(tft) - tft->poll_last >= tft->poll_interval;
+}
+
+uint32_t eatft_poll_next(struct eatft *tft)
+{
+    uint32_t elapsed;
+
+    if (tft->state != EATFT_READY || tft->olen > 0 || tft->bulk != NULL
+        || tft->clock == NULL)
+        return 0;
+
+    elapsed = eatft_clock(tft) - tft->poll_last;
+
+    return elapsed >= tft->poll_interval ? 0 : tft->poll_interval - elapsed;
+}
+
+static void eatft_poll_adapt(struct eatft *tft, bool activity)
+{
+    if (activity || tft->grab != 0 || tft->nqueries > 0) {
+        tft->poll_interval = tft->poll_min;
+    } else if (tft->poll_interval < tft->poll_max) {
+        tft->poll_interval += tft->poll_interval / 2 + 1;
+        if (tft->poll_interval > tft->poll_max)
+            tft->poll_interval = tft->poll_max;
+    }
+}
+
 void eatft_poll(struct eatft *tft)
 {
+    tft->poll_last = eatft_clock(tft);
+
     tft->obuf[0] = 'S';
     tft->bcc += 'S';
     tft->olen = 1;
 
+    eatft_trace(tft, EATFT_TRACE_POLL, 0);
+    eatft_query_polled(tft);
+
     /* overwrite defaults */
     tft->next_state = EATFT_RECEIVE;
     tft->dc = EATFT_DC2;
@@ -80,93 +135,326 @@ void eatft_flush(struct eatft *tft)
         /* append checksum */
         tft->obuf[tft->olen] = tft->bcc;
 
+        eatft_trace(tft, EATFT_TRACE_FLUSH, tft->olen);
+        eatft_lane_account(tft);
+
+        if (tft->cost) {
+            /* DCx, len and checksum */
+            tft->cost->bytes += tft->olen + 3;
+            tft->cost->packets++;
+            eatft_reset_buffer(tft);
+            return;
+        }
+
+        tft->tx_bytes += tft->olen + 3;
+
         /* schedule transmit */
         tft->state = EATFT_TRANSMIT;
     }
 }
 
-/**
- * Sends commands to display.
- * Uses a printf like syntax for formatting.
- * NOTE: All strings are expected to lie in PROGMEM.
- * Integers are placed as binary values as expected by the EA TFT display.
- * Supported format specifiers:
- * %c 8 bit binary
- * %D 16 bit binary
- * %s char*
- */
-int eatft_appendf(struct eatft *tft, const char *fmt, ...)
+/* flushes when a command of len bytes would not fit into the packet */
+void eatft_reserve(struct eatft *tft, uint8_t len)
 {
-    const char *p;
-    va_list args;
-    uint16_t i;
-    char *s;
-    uint8_t *rp;
-    char fmtstr[32];
+    /* one byte is needed for the checksum */
+    bool full = tft->olen + len >= CONFIG_EATFT_OBUF_SIZE;
+    /* a new packet waits from here on, also for the one on the wire */
+    bool fresh = full || tft->olen == 0 || tft->state != EATFT_READY;
+    uint32_t since = fresh ? eatft_clock(tft) : 0;
+
+    if (full)
+        eatft_flush(tft);
 
+    /* the buffer must not be touched before it has been sent */
     while (tft->state != EATFT_READY) {
         eatft_process(tft);
     }
 
-    rp = tft->obuf + tft->olen;
+    if (fresh)
+        tft->lane_since = since;
+}
 
-    /* prepend escape */
-    *rp = 0x1b;
-    tft->bcc += *rp++;
+/* output cursor, only counts when rp is NULL */
+struct eatft_out {
+    uint8_t *rp;
+    uint8_t *end;
+    uint16_t len;
+};
 
-    strcpy_P(fmtstr, fmt);
-    va_start(args, fmt);
+#define EATFT_FMT_LEFT 0x01
+#define EATFT_FMT_ZERO 0x02
+
+static void eatft_put(struct eatft_out *out, uint8_t c)
+{
+    if (out->rp != NULL && out->rp < out->end)
+        *out->rp++ = c;
+    out->len++;
+}
+
+static void eatft_put_pad(struct eatft_out *out, uint8_t c, uint8_t n)
+{
+    while (n--)
+        eatft_put(out, c);
+}
+
+/**
+ * Emits an ASCII number. With prec set the number is a fixed point value
+ * with prec decimal places, e.g. 1234 with prec 2 gives 12.34.
+ */
+static void eatft_put_number(struct eatft_out *out, uint32_t v, bool neg,
+                             uint8_t base, char alpha, uint8_t flags,
+                             uint8_t width, uint8_t prec)
+{
+    char buf[16];
+    uint8_t n = 0;
+    uint8_t d;
+    uint8_t pad;
+
+    /* digits in reverse order */
+    do {
+        d = v % base;
+        buf[n++] = d < 10 ? '0' + d : alpha + d - 10;
+        v /= base;
+
+        if (n == prec)
+            buf[n++] = '.';
+    } while (v || (prec && n <= prec + 1));
+
+    pad = width > n + neg ? width - n - neg : 0;
+
+    if (!(flags & (EATFT_FMT_LEFT | EATFT_FMT_ZERO)))
+        eatft_put_pad(out, ' ', pad);
+    if (neg)
+        eatft_put(out, '-');
+    if (flags & EATFT_FMT_ZERO)
+        eatft_put_pad(out, '0', pad);
+
+    while (n)
+        eatft_put(out, buf[--n]);
+
+    if (flags & EATFT_FMT_LEFT)
+        eatft_put_pad(out, ' ', pad);
+}
 
-    for(p = fmtstr; *p != '\0'; p++) {
-        if(*p != '%') {
-            *rp++ = *p;
-            tft->bcc += *p;
+static void eatft_put_string(struct eatft_out *out, const char *s,
+                             uint8_t flags, uint8_t width)
+{
+    uint8_t len = strlen(s);
+    uint8_t pad = width > len ? width - len : 0;
+
+    if (!(flags & EATFT_FMT_LEFT))
+        eatft_put_pad(out, ' ', pad);
+    while (*s)
+        eatft_put(out, *s++);
+    if (flags & EATFT_FMT_LEFT)
+        eatft_put_pad(out, ' ', pad);
+}
+
+/**
+ * Formatter shared by commands and texts.
+ * In command mode %c is a binary byte, %D a binary 16 bit value, %s
+ * includes the terminating zero and %V embeds a formatted text.
+ * In text mode %c is a character and %s is copied without terminator.
+ * Both modes know %d, %i, %u, %x and %X with optional flags '-' and '0',
+ * width, precision for fixed point values and the 'l' modifier.
+ */
+static void eatft_vformat(struct eatft_out *out, const char *fmt,
+                          va_list *args, bool text)
+{
+    struct eatft_vaf *vaf;
+    va_list vargs;
+    const char *p;
+    uint8_t flags, width, prec;
+    bool is_long;
+    uint32_t u;
+    int32_t i;
+    char *s;
+
+    for (p = fmt; *p != '\0'; p++) {
+        if (*p != '%') {
+            eatft_put(out, *p);
             continue;
         }
 
-        switch(*++p) {
+        flags = 0;
+        width = 0;
+        prec = 0;
+        is_long = false;
+
+        for (;; p++) {
+            if (p[1] == '-')
+                flags |= EATFT_FMT_LEFT;
+            else if (p[1] == '0')
+                flags |= EATFT_FMT_ZERO;
+            else
+                break;
+        }
+        while (p[1] >= '0' && p[1] <= '9')
+            width = width * 10 + *++p - '0';
+        if (p[1] == '.') {
+            p++;
+            while (p[1] >= '0' && p[1] <= '9')
+                prec = prec * 10 + *++p - '0';
+        }
+        if (p[1] == 'l') {
+            p++;
+            is_long = true;
+        }
+
+        /* a trailing % has no conversion */
+        if (p[1] == '\0')
+            break;
+
+        switch (*++p) {
         case 'c':
-            *rp = (char)va_arg(args, int);
-            tft->bcc += *rp++;
+            eatft_put(out, (uint8_t)va_arg(*args, int));
             break;
 
         case 'D':
-            i = (uint16_t)va_arg(args, int);
-            *rp = i;
-            tft->bcc += *rp++;
-            *rp = i >> 8;
-            tft->bcc += *rp++;
+            u = (uint16_t)va_arg(*args, int);
+            eatft_put(out, u);
+            eatft_put(out, u >> 8);
+            break;
+
+        case 'd':
+        case 'i':
+            i = is_long ? va_arg(*args, long) : va_arg(*args, int);
+            u = i < 0 ? -(uint32_t)i : (uint32_t)i;
+            eatft_put_number(out, u, i < 0, 10, 'a', flags, width, prec);
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+            u = is_long ? va_arg(*args, unsigned long)
+                : va_arg(*args, unsigned int);
+            eatft_put_number(out, u, false, *p == 'u' ? 10 : 16,
+                             *p == 'X' ? 'A' : 'a', flags, width, prec);
             break;
 
         case 's':
-            s = va_arg(args, char*);
-            do {
-                tft->bcc += *s;
-                *rp++ = *s;
-            } while (*s++ != '\0');
+            s = va_arg(*args, char*);
+            eatft_put_string(out, s, flags, width);
+            if (!text)
+                eatft_put(out, '\0');
+            break;
+
+        case 'V':
+            vaf = va_arg(*args, struct eatft_vaf *);
+
+            /* counting must leave the embedded arguments untouched */
+            if (out->rp == NULL) {
+                va_copy(vargs, *vaf->args);
+                eatft_vformat(out, vaf->fmt, &vargs, true);
+                va_end(vargs);
+            } else {
+                eatft_vformat(out, vaf->fmt, vaf->args, true);
+            }
+            eatft_put(out, '\0');
             break;
 
         case '%':
-            *rp = '%';
-            tft->bcc += *rp++;
+            eatft_put(out, '%');
             break;
         default:
+            /* shown as is, the arguments after it are off by one */
             dbg("WARNING: unknown format character\n");
+            eatft_put(out, '%');
+            eatft_put(out, *p);
         }
     }
+}
+
+/**
+ * Sends commands to display.
+ * Uses a printf like syntax for formatting.
+ * NOTE: All strings are expected to lie in PROGMEM.
+ * Integers are placed as binary values as expected by the EA TFT display.
+ * Supported format specifiers:
+ * %c 8 bit binary
+ * %D 16 bit binary
+ * %s char*
+ * %d %i %u %x ASCII numbers, e.g. %5d, %-5u, %04x, %.2d for 12.34, %ld
+ * %V struct eatft_vaf*, a formatted text including terminator
+ */
+int eatft_appendf(struct eatft *tft, const char *fmt, ...)
+{
+    struct eatft_out out;
+    va_list args;
+    uint8_t *p;
+    char fmtstr[32];
+
+    strcpy_P(fmtstr, fmt);
+
+    /* count first and start a new packet if the command does not fit */
+    out.rp = NULL;
+    out.len = 1;
+    va_start(args, fmt);
+    eatft_vformat(&out, fmtstr, &args, false);
+    va_end(args);
+
+    DEBUG_ASSERT(out.len < CONFIG_EATFT_OBUF_SIZE);
+    eatft_reserve(tft, out.len);
+
+    out.rp = tft->obuf + tft->olen;
+    out.len = 0;
+    /* keep one byte for the checksum */
+    out.end = tft->obuf + CONFIG_EATFT_OBUF_SIZE - 1;
+
+    /* prepend escape */
+    eatft_put(&out, 0x1b);
+
+    va_start(args, fmt);
+    eatft_vformat(&out, fmtstr, &args, false);
     va_end(args);
 
-    tft->olen = rp - tft->obuf;
+    /* oversized texts are cut, but stay terminated */
+    if (out.rp - tft->obuf - tft->olen < out.len)
+        out.rp[-1] = '\0';
+
+    for (p = tft->obuf + tft->olen; p < out.rp; p++)
+        tft->bcc += *p;
+
+    tft->olen = out.rp - tft->obuf;
 
     return tft->olen;
 }
 
+/**
+ * Appends commands encoded elsewhere, e.g. forwarded from another process.
+ * The data must hold complete commands only.
+ */
+void eatft_append(struct eatft *tft, const uint8_t *data, uint8_t len)
+{
+    uint8_t i;
+
+    DEBUG_ASSERT(len < CONFIG_EATFT_OBUF_SIZE);
+    eatft_reserve(tft, len);
+
+    for (i = 0; i < len; i++) {
+        tft->obuf[tft->olen++] = data[i];
+        tft->bcc += data[i];
+    }
+}
+
 void eatft_process(struct eatft *tft)
 {
+    enum eatft_state state = tft->state;
+
+    /* nothing goes on the wire while costs are measured */
+    if (tft->cost)
+        return;
+
     if (tft->ready(tft)) {
         switch (tft->state) {
         case EATFT_READY:
-            eatft_poll(tft);
+            /* drawing goes first, a poll would overwrite the packet */
+            if (tft->olen > 0)
+                eatft_flush(tft);
+            else if (eatft_poll_due(tft))
+                eatft_poll(tft);
+            else if (tft->bulk && tft->lane != EATFT_LANE_BULK)
+                eatft_bulk_fill(tft);
             break;
 
         case EATFT_TRANSMIT:
@@ -181,17 +469,27 @@ void eatft_process(struct eatft *tft)
 
         case EATFT_EVENT:
             tft->state = EATFT_RESET;
+            eatft_trace(tft, EATFT_TRACE_RX, tft->ilen);
 
             if (tft->ibuf[1] > 0
                 && eatft_chk_matches(tft)) {
                 eatft_dispatch_event(tft);
+                eatft_poll_adapt(tft, true);
+            } else {
+                eatft_poll_adapt(tft, false);
             }
+
+            /* deferred callbacks must not run from here */
+            if (!eatft_events_deferred(tft))
+                eatft_query_expire(tft);
             break;
 
         case EATFT_RESET:
             eatft_reset_buffer(tft);
             break;
         }
-    }
 
+        if (tft->state != state)
+            eatft_trace(tft, EATFT_TRACE_STATE, tft->state);
+    }
 }
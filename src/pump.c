@@ -0,0 +1,159 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <eatft.h>
+#include <eatft_pump.h>
+
+static void eatft_pump_transmit(struct eatft *tft)
+{
+    struct eatft_pump *pump = tft->driver;
+
+    pump->state = EATFT_PUMP_SELECT;
+    pump->ops->select(pump->hw, true);
+    pump->ops->delay(pump->hw, CONFIG_EATFT_PUMP_SELECT_US);
+}
+
+static void eatft_pump_receive(struct eatft *tft)
+{
+    struct eatft_pump *pump = tft->driver;
+
+    pump->state = EATFT_PUMP_RECEIVE_SELECT;
+    pump->ops->select(pump->hw, true);
+    pump->ops->delay(pump->hw, CONFIG_EATFT_PUMP_SELECT_US);
+}
+
+static bool eatft_pump_ready(struct eatft *tft)
+{
+    struct eatft_pump *pump = tft->driver;
+    return pump->state == EATFT_PUMP_READY;
+}
+
+void eatft_pump_init(struct eatft_pump *pump, struct eatft *tft,
+                     const struct eatft_pump_ops *ops, void *hw)
+{
+    pump->tft = tft;
+    pump->ops = ops;
+    pump->hw = hw;
+    pump->state = EATFT_PUMP_READY;
+
+    tft->driver = pump;
+    tft->transmit = eatft_pump_transmit;
+    tft->receive = eatft_pump_receive;
+    tft->ready = eatft_pump_ready;
+}
+
+void eatft_pump_timeout(struct eatft_pump *pump)
+{
+    struct eatft *tft = pump->tft;
+
+    switch (pump->state) {
+    case EATFT_PUMP_SELECT:
+        eatft_trace(tft, EATFT_TRACE_DRIVER, EATFT_PUMP_SELECT);
+
+        /* add DCx, len and bcc to len */
+        pump->pos = &tft->dc;
+        pump->len = tft->olen + 3;
+
+        pump->state = EATFT_PUMP_SEND;
+        pump->ops->write(pump->hw, *pump->pos++);
+        break;
+
+    case EATFT_PUMP_WAIT:
+        /* trigger SPI for reading ACK */
+        pump->state = EATFT_PUMP_ACK;
+        pump->ops->select(pump->hw, true);
+        pump->ops->write(pump->hw, 0x00);
+        break;
+
+    case EATFT_PUMP_RECEIVE_SELECT:
+        /* DCx and len */
+        pump->pos = tft->ibuf;
+        pump->len = 2;
+
+        pump->state = EATFT_PUMP_RECEIVE_HEADER;
+        pump->ops->write(pump->hw, 0x00);
+        break;
+    }
+}
+
+void eatft_pump_complete(struct eatft_pump *pump, uint8_t byte)
+{
+    struct eatft *tft = pump->tft;
+
+    switch (pump->state) {
+    case EATFT_PUMP_SEND:
+        if (--pump->len > 0) {
+            pump->ops->write(pump->hw, *pump->pos++);
+        } else {
+            eatft_trace(tft, EATFT_TRACE_DRIVER, EATFT_PUMP_WAIT);
+            pump->ops->select(pump->hw, false);
+            pump->state = EATFT_PUMP_WAIT;
+            pump->ops->delay(pump->hw, CONFIG_EATFT_PUMP_ACK_US);
+        }
+        break;
+
+    case EATFT_PUMP_ACK:
+        pump->ops->select(pump->hw, false);
+
+        if (byte == EATFT_ACK) {
+            eatft_trace(tft, EATFT_TRACE_ACK, byte);
+            pump->state = EATFT_PUMP_READY;
+        } else {
+            /* NAK or something, try again */
+            eatft_trace(tft, EATFT_TRACE_NAK, byte);
+            eatft_pump_transmit(tft);
+        }
+        break;
+
+    case EATFT_PUMP_RECEIVE_HEADER:
+        *pump->pos++ = byte;
+
+        if (--pump->len == 0) {
+            /* len + checksum, never more than fits into ibuf */
+            if (tft->ibuf[1] + 3 > CONFIG_EATFT_IBUF_SIZE)
+                tft->ibuf[1] = CONFIG_EATFT_IBUF_SIZE - 3;
+
+            pump->len = tft->ibuf[1] + 1;
+            tft->ilen = pump->len + 2;
+            pump->state = EATFT_PUMP_RECEIVE_PAYLOAD;
+        }
+        pump->ops->write(pump->hw, 0x00);
+        break;
+
+    case EATFT_PUMP_RECEIVE_PAYLOAD:
+        *pump->pos++ = byte;
+
+        if (--pump->len > 0) {
+            pump->ops->write(pump->hw, 0x00);
+        } else {
+            pump->ops->select(pump->hw, false);
+            pump->state = EATFT_PUMP_READY;
+        }
+        break;
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "private.h"
+
+static void eatft_query_drop(struct eatft *tft, uint8_t i)
+{
+    tft->nqueries--;
+    memmove(&tft->queries[i], &tft->queries[i + 1],
+            (tft->nqueries - i) * sizeof(tft->queries[0]));
+}
+
+int eatft_query_expect(struct eatft *tft, uint8_t code, int16_t arg,
+                       eatft_query_callback_t fun, void *priv)
+{
+    struct eatft_query q;
+
+    if (tft->nqueries >= CONFIG_EATFT_QUERIES)
+        return ERROR;
+
+    q.code = code;
+    q.arg = arg;
+    q.fun = fun;
+    q.priv = priv;
+    q.sent = eatft_clock(tft);
+    q.polls = 0;
+    tft->queries[tft->nqueries++] = q;
+
+    return OK;
+}
+
+int eatft_query_switch(struct eatft *tft, uint8_t code,
+                       eatft_query_callback_t fun, void *priv)
+{
+    if (eatft_query_expect(tft, 'X', code, fun, priv) != OK)
+        return ERROR;
+
+    eatft_appendf(tft, PSTR("AX%c"), code);
+    return OK;
+}
+
+int eatft_query_bar(struct eatft *tft, uint8_t n,
+                    eatft_query_callback_t fun, void *priv)
+{
+    if (eatft_query_expect(tft, 'B', n, fun, priv) != OK)
+        return ERROR;
+
+    eatft_appendf(tft, PSTR("BS%c"), n);
+    return OK;
+}
+
+int eatft_query_version(struct eatft *tft, eatft_query_callback_t fun,
+                        void *priv)
+{
+    if (eatft_query_expect(tft, 'V', -1, fun, priv) != OK)
+        return ERROR;
+
+    eatft_appendf(tft, PSTR("SV"));
+    return OK;
+}
+
+uint8_t eatft_query_pending(const struct eatft *tft)
+{
+    return tft->nqueries;
+}
+
+/**
+ * Hands a received record to the oldest matching query, returns false
+ * when no query waits for it.
+ */
+bool eatft_query_dispatch(struct eatft *tft, uint8_t code,
+                          const uint8_t *data, uint8_t len)
+{
+    struct eatft_query q;
+    uint8_t i;
+
+    for (i = 0; i < tft->nqueries; i++) {
+        q = tft->queries[i];
+
+        if (q.code != code)
+            continue;
+
+        if (q.arg < 0) {
+            eatft_query_drop(tft, i);
+            q.fun(tft, q.priv, data, len);
+            return true;
+        }
+
+        if (len >= 1 && data[0] == q.arg) {
+            /* the slot is free before the callback may query again */
+            eatft_query_drop(tft, i);
+            q.fun(tft, q.priv, data + 1, len - 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* counts the polls sent while queries wait */
+void eatft_query_polled(struct eatft *tft)
+{
+    uint8_t i;
+
+    for (i = 0; i < tft->nqueries; i++)
+        if (tft->queries[i].polls < 0xff)
+            tft->queries[i].polls++;
+}
+
+/* by time, or by the number of polls without a registered clock */
+void eatft_query_expire(struct eatft *tft)
+{
+    uint32_t now = eatft_clock(tft);
+    struct eatft_query q;
+    bool expired;
+    uint8_t i = 0;
+
+    while (i < tft->nqueries) {
+        q = tft->queries[i];
+
+        if (tft->clock)
+            expired = now - q.sent > CONFIG_EATFT_QUERY_TIMEOUT_US;
+        else
+            expired = q.polls > CONFIG_EATFT_QUERY_TIMEOUT_POLLS;
+
+        if (expired) {
+            eatft_query_drop(tft, i);
+            q.fun(tft, q.priv, NULL, 0);
+        } else {
+            i++;
+        }
+    }
+}
@@ -0,0 +1,206 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "private.h"
+
+#if CONFIG_EATFT_SCHED_SLOTS > 32
+#  error "CONFIG_EATFT_SCHED_SLOTS must not exceed 32"
+#endif
+
+/* wrap safe comparison of clock values */
+#define TIME_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+void eatft_sched_init(struct eatft_sched *sched, struct eatft *tft,
+                      uint32_t rate)
+{
+    memset(sched, 0, sizeof(*sched));
+
+    sched->tft = tft;
+    sched->rate = rate;
+    sched->credit = CONFIG_EATFT_SCHED_BURST;
+    sched->last = eatft_clock(tft);
+}
+
+/**
+ * Submits an update for key, an update still pending for the same key is
+ * superseded. The deadline is relative to now in microseconds, the earlier
+ * deadline and higher priority of both updates is kept.
+ */
+int eatft_sched_submit(struct eatft_sched *sched, const void *key,
+                       uint8_t priority, uint32_t deadline,
+                       eatft_update_t fun, void *arg)
+{
+    struct eatft_update *upd = NULL;
+    struct eatft_update *slot = NULL;
+    uint32_t now = eatft_clock(sched->tft);
+    int i;
+
+    for (i = 0; i < CONFIG_EATFT_SCHED_SLOTS; i++) {
+        if (sched->updates[i].fun == NULL) {
+            if (slot == NULL)
+                slot = &sched->updates[i];
+        } else if (sched->updates[i].key == key) {
+            upd = &sched->updates[i];
+            break;
+        }
+    }
+
+    deadline += now;
+
+    if (upd) {
+        sched->superseded++;
+
+        if (priority < upd->priority)
+            upd->priority = priority;
+        if (TIME_BEFORE(deadline, upd->deadline))
+            upd->deadline = deadline;
+    } else if (slot) {
+        upd = slot;
+        upd->key = key;
+        upd->priority = priority;
+        upd->deadline = deadline;
+        upd->submitted = now;
+    } else {
+        dbg("WARNING: scheduler full\n");
+        sched->rejected++;
+        return ERROR;
+    }
+
+    upd->fun = fun;
+    upd->arg = arg;
+
+    return OK;
+}
+
+/* best of the slots set in due, returns the slot index or -1 */
+static int eatft_sched_next(struct eatft_sched *sched, uint32_t due)
+{
+    struct eatft_update *best = NULL;
+    struct eatft_update *upd;
+    int index = -1;
+    int i;
+
+    for (i = 0; i < CONFIG_EATFT_SCHED_SLOTS; i++) {
+        upd = &sched->updates[i];
+
+        if (upd->fun == NULL || !(due & (1UL << i)))
+            continue;
+
+        if (best == NULL
+            || upd->priority < best->priority
+            || (upd->priority == best->priority
+                && TIME_BEFORE(upd->deadline, best->deadline))) {
+            best = upd;
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * Runs pending updates as long as the budget allows. Without a registered
+ * clock or with a rate of 0 the budget is unlimited. Only updates pending
+ * on entry run, those submitted meanwhile wait for the next call.
+ */
+void eatft_sched_run(struct eatft_sched *sched)
+{
+    struct eatft *tft = sched->tft;
+    struct eatft_update *upd;
+    eatft_update_t fun;
+    bool limited = tft->clock != NULL && sched->rate > 0;
+    uint32_t now = eatft_clock(tft);
+    uint32_t elapsed;
+    uint32_t sent;
+    uint32_t due = 0;
+    int i;
+
+    if (limited) {
+        elapsed = now - sched->last;
+        sched->last = now;
+
+        /* avoid overflows after long idle periods */
+        if (elapsed > 1000000)
+            elapsed = 1000000;
+
+        sched->credit += (int32_t)(((uint64_t)elapsed * sched->rate) / 1000000);
+        if (sched->credit > CONFIG_EATFT_SCHED_BURST)
+            sched->credit = CONFIG_EATFT_SCHED_BURST;
+    }
+
+    for (i = 0; i < CONFIG_EATFT_SCHED_SLOTS; i++)
+        if (sched->updates[i].fun != NULL)
+            due |= 1UL << i;
+
+    while ((!limited || sched->credit > 0)
+           && (i = eatft_sched_next(sched, due)) >= 0) {
+        upd = &sched->updates[i];
+        due &= ~(1UL << i);
+
+        /* the update may submit itself again */
+        fun = upd->fun;
+        upd->fun = NULL;
+
+        sent = tft->tx_bytes;
+        fun(tft, upd->arg);
+        eatft_flush(tft);
+
+        /* the cost is only known afterwards, overdraws are paid back later */
+        if (limited)
+            sched->credit -= tft->tx_bytes - sent;
+    }
+}
+
+uint8_t eatft_sched_pending(const struct eatft_sched *sched)
+{
+    uint8_t n = 0;
+    int i;
+
+    for (i = 0; i < CONFIG_EATFT_SCHED_SLOTS; i++)
+        if (sched->updates[i].fun != NULL)
+            n++;
+
+    return n;
+}
+
+/* age of the oldest pending update in microseconds */
+uint32_t eatft_sched_lag(const struct eatft_sched *sched)
+{
+    uint32_t now = eatft_clock(sched->tft);
+    uint32_t lag = 0;
+    int i;
+
+    for (i = 0; i < CONFIG_EATFT_SCHED_SLOTS; i++) {
+        if (sched->updates[i].fun != NULL
+            && now - sched->updates[i].submitted > lag) {
+            lag = now - sched->updates[i].submitted;
+        }
+    }
+
+    return lag;
+}
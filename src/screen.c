@@ -0,0 +1,261 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "private.h"
+
+#if CONFIG_EATFT_SCREEN_ELEMENTS > 32
+#  error "element sets are tracked in 32 bit masks"
+#endif
+
+#define NAV_TEXT 32
+
+static void eatft_element_load(struct eatft_element *el,
+                               const struct eatft_element *elements,
+                               uint8_t i)
+{
+    memcpy_P(el, &elements[i], sizeof(*el));
+}
+
+static void eatft_element_text(const struct eatft_element *el, char *buf)
+{
+    buf[0] = '\0';
+    if (el->text) {
+        strncpy_P(buf, el->text, NAV_TEXT - 1);
+        buf[NAV_TEXT - 1] = '\0';
+    }
+}
+
+static bool eatft_element_equal(const struct eatft_element *a,
+                                const struct eatft_element *b)
+{
+    char buf[NAV_TEXT];
+
+    if (a->type != b->type || a->font != b->font || a->fg != b->fg
+        || a->bg != b->bg || a->pos != b->pos || a->fun != b->fun
+        || a->priv != b->priv
+        || memcmp(&a->rect, &b->rect, sizeof(a->rect)) != 0)
+        return false;
+
+    if (a->text == b->text)
+        return true;
+
+    if (a->text == NULL || b->text == NULL)
+        return false;
+
+    eatft_element_text(a, buf);
+    return strcmp_P(buf, b->text) == 0;
+}
+
+static bool eatft_element_is_widget(const struct eatft_element *el)
+{
+    return el->type == EATFT_EL_BUTTON || el->type == EATFT_EL_SWITCH;
+}
+
+static bool eatft_rect_overlaps(const struct eatft_rect *a,
+                                const struct eatft_rect *b)
+{
+    return a->x <= b->x + b->width && b->x <= a->x + a->width
+        && a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+/* draws el, widgets reuse the touch code of wdt */
+static void eatft_element_draw(struct eatft *tft,
+                               const struct eatft_element *el,
+                               struct eatft_widget *wdt)
+{
+    const struct eatft_rect *r = &el->rect;
+    char text[NAV_TEXT];
+    uint8_t code;
+
+    eatft_element_text(el, text);
+
+    switch (el->type) {
+    case EATFT_EL_FILL:
+        eatft_rect_filli(tft, r->x, r->y, r->width, r->height, el->fg);
+        break;
+
+    case EATFT_EL_TEXT:
+        eatft_setfont(tft, el->font);
+        eatft_setfontcolor(tft, el->fg, el->bg);
+        eatft_text_drawi(tft, r->x, r->y, r->width, r->height,
+                         el->pos, text);
+        break;
+
+    case EATFT_EL_BUTTON:
+        code = eatft_wdt_code(tft, wdt);
+        eatft_button_createi(tft, r->x, r->y, r->width, r->height,
+                             code | 0x80, code, el->pos, text);
+        break;
+
+    case EATFT_EL_SWITCH:
+        code = eatft_wdt_code(tft, wdt);
+        eatft_switch_createi(tft, r->x, r->y, r->width, r->height,
+                             code | 0x80, code, el->pos, text);
+        break;
+    }
+}
+
+void eatft_nav_init(struct eatft_nav *nav, struct eatft *tft)
+{
+    memset(nav, 0, sizeof(*nav));
+    nav->tft = tft;
+}
+
+/**
+ * True when the current screen owns every allocated widget. With a code
+ * base the display is shared and other buttons may be out of sight.
+ */
+static bool eatft_nav_owns_all(struct eatft_nav *nav, uint8_t owned)
+{
+    uint8_t used = 0;
+    uint8_t i;
+
+    if (nav->tft->code_base)
+        return false;
+
+    for (i = 0; i < CONFIG_EATFT_MAX_WIDGETS; i++) {
+        if (nav->tft->widgets[i].type != EATFT_WDT_FREE)
+            used++;
+    }
+
+    return used == owned;
+}
+
+int eatft_nav_show(struct eatft_nav *nav, const struct eatft_element *elements,
+                   uint8_t count)
+{
+    struct eatft *tft = nav->tft;
+    struct eatft_widget *widgets[CONFIG_EATFT_SCREEN_ELEMENTS];
+    struct eatft_element a, b;
+    uint32_t kept = 0;
+    uint32_t added = 0;
+    uint8_t removed = 0;
+    uint8_t owned = 0;
+    uint8_t i, j;
+
+    if (count > CONFIG_EATFT_SCREEN_ELEMENTS)
+        return ERROR;
+
+    memset(widgets, 0, sizeof(widgets));
+
+    /* match the new elements against the current ones */
+    for (j = 0; j < count; j++) {
+        eatft_element_load(&b, elements, j);
+        added |= 1UL << j;
+
+        for (i = 0; i < nav->count; i++) {
+            if (kept & (1UL << i))
+                continue;
+
+            eatft_element_load(&a, nav->elements, i);
+            if (eatft_element_equal(&a, &b)) {
+                kept |= 1UL << i;
+                added &= ~(1UL << j);
+                widgets[j] = nav->widgets[i];
+                break;
+            }
+        }
+    }
+
+    /* removals go out in one packet, or as one command when possible */
+    for (i = 0; i < nav->count; i++) {
+        if (nav->widgets[i]) {
+            owned++;
+            if (!(kept & (1UL << i)))
+                removed++;
+        }
+    }
+
+    if (removed > 1 && removed == owned && eatft_nav_owns_all(nav, owned)) {
+        eatft_button_remove(tft, 0);
+        for (i = 0; i < nav->count; i++) {
+            if (nav->widgets[i])
+                memset(nav->widgets[i], 0, sizeof(*nav->widgets[i]));
+        }
+    } else {
+        for (i = 0; i < nav->count; i++) {
+            if (nav->widgets[i] && !(kept & (1UL << i)))
+                eatft_wdt_release(tft, nav->widgets[i]);
+        }
+    }
+
+    for (i = 0; i < nav->count; i++) {
+        if (kept & (1UL << i))
+            continue;
+
+        eatft_element_load(&a, nav->elements, i);
+        if (!eatft_element_is_widget(&a))
+            eatft_rect_cleari(tft, a.rect.x, a.rect.y,
+                              a.rect.width, a.rect.height);
+    }
+
+    /* draw in screen order, redrawing kept elements that were uncovered */
+    for (j = 0; j < count; j++) {
+        eatft_element_load(&b, elements, j);
+
+        if (!(added & (1UL << j))) {
+            for (i = 0; i < nav->count; i++) {
+                if (kept & (1UL << i))
+                    continue;
+
+                eatft_element_load(&a, nav->elements, i);
+                if (eatft_rect_overlaps(&a.rect, &b.rect))
+                    break;
+            }
+
+            if (i == nav->count)
+                continue;
+
+            if (widgets[j])
+                eatft_button_undefine(tft, eatft_wdt_code(tft, widgets[j]));
+        } else if (eatft_element_is_widget(&b)) {
+            widgets[j] = eatft_wdt_alloc(tft, b.type == EATFT_EL_BUTTON
+                                         ? EATFT_WDT_BUTTON
+                                         : EATFT_WDT_SWITCH);
+            if (widgets[j] == NULL)
+                continue;
+
+            widgets[j]->fun = b.fun;
+            widgets[j]->priv = b.priv;
+        }
+
+        eatft_element_draw(tft, &b, widgets[j]);
+    }
+
+    nav->elements = elements;
+    nav->count = count;
+    memcpy(nav->widgets, widgets, sizeof(widgets));
+
+    eatft_flush(tft);
+
+    return OK;
+}
+
+struct eatft_widget *eatft_nav_widget(struct eatft_nav *nav, uint8_t index)
+{
+    return index < nav->count ? nav->widgets[index] : NULL;
+}
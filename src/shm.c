@@ -0,0 +1,429 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <eatft.h>
+#include <eatft_shm.h>
+#include <eatft_unix.h>
+
+#define RING_MASK (EATFT_SHM_RING - 1)
+
+#if EATFT_SHM_RING & RING_MASK
+#  error "EATFT_SHM_RING must be a power of two"
+#endif
+
+#define EVENTS_MASK (EATFT_SHM_EVENTS - 1)
+
+#if EATFT_SHM_EVENTS & EVENTS_MASK
+#  error "EATFT_SHM_EVENTS must be a power of two"
+#endif
+
+#define LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+struct shm_driver {
+    struct eatft_shm *shm;
+    struct eatft_shm_client *slot;
+};
+
+static void shm_futex_wait(uint32_t *addr, uint32_t val, uint32_t timeout_us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = timeout_us / 1000000;
+    ts.tv_nsec = timeout_us % 1000000 * 1000;
+
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static void shm_futex_wake(uint32_t *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static struct eatft_shm *shm_map(const char *name, int flags)
+{
+    struct eatft_shm *shm;
+    int fd;
+
+    if ((fd = shm_open(name, flags, 0660)) < 0) {
+        perror(name);
+        return NULL;
+    }
+
+    if ((flags & O_CREAT) && ftruncate(fd, sizeof(*shm)) < 0) {
+        perror(name);
+        close(fd);
+        return NULL;
+    }
+
+    shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (shm == MAP_FAILED) {
+        perror(name);
+        return NULL;
+    }
+
+    return shm;
+}
+
+/* client */
+
+/* room for the largest packet the client can build */
+static bool shm_ready(struct eatft *tft)
+{
+    struct shm_driver *priv = tft->driver;
+    struct eatft_shm_client *c = priv->slot;
+    uint32_t tail;
+
+    if (tft->state != EATFT_TRANSMIT)
+        return true;
+
+    tail = LOAD(&c->cmd_tail);
+    if (EATFT_SHM_RING - (c->cmd_head - tail) > CONFIG_EATFT_OBUF_SIZE)
+        return true;
+
+    STORE(&c->cmd_waiting, 1);
+    shm_futex_wait(&c->cmd_tail, tail, 1000);
+
+    return false;
+}
+
+static void shm_transmit(struct eatft *tft)
+{
+    struct shm_driver *priv = tft->driver;
+    struct eatft_shm_client *c = priv->slot;
+    uint32_t head = c->cmd_head;
+    uint8_t i;
+
+    /* polls are answered locally in shm_receive() */
+    if (tft->dc != EATFT_DC1)
+        return;
+
+    c->ring[head++ & RING_MASK] = tft->olen;
+    for (i = 0; i < tft->olen; i++)
+        c->ring[head++ & RING_MASK] = tft->obuf[i];
+
+    STORE(&c->cmd_head, head);
+
+    __atomic_add_fetch(&priv->shm->seq, 1, __ATOMIC_RELEASE);
+    shm_futex_wake(&priv->shm->seq);
+}
+
+/* builds a send buffer frame from the events routed to this client */
+static void shm_receive(struct eatft *tft)
+{
+    struct shm_driver *priv = tft->driver;
+    struct eatft_shm_client *c = priv->slot;
+    struct eatft_shm_event *ev;
+    uint32_t head = LOAD(&c->ev_head);
+    uint8_t len = 0;
+    uint8_t bcc;
+    uint8_t i;
+
+    tft->ibuf[0] = EATFT_DC1;
+
+    while (c->ev_tail != head) {
+        ev = &c->events[c->ev_tail & EVENTS_MASK];
+
+        /* header and checksum stay outside */
+        if (2 + len + 3 + ev->len + 1 > CONFIG_EATFT_IBUF_SIZE)
+            break;
+
+        tft->ibuf[2 + len++] = 0x1b;
+        tft->ibuf[2 + len++] = ev->code;
+        tft->ibuf[2 + len++] = ev->len;
+        memcpy(tft->ibuf + 2 + len, ev->data, ev->len);
+        len += ev->len;
+
+        STORE(&c->ev_tail, c->ev_tail + 1);
+    }
+
+    tft->ibuf[1] = len;
+
+    bcc = 0;
+    for (i = 0; i < len + 2; i++)
+        bcc += tft->ibuf[i];
+    tft->ibuf[i] = bcc;
+
+    tft->ilen = len + 3;
+}
+
+int eatft_shm_create(struct eatft *tft, const char *name)
+{
+    struct shm_driver *priv;
+    struct eatft_shm *shm;
+    struct eatft_shm_client *c;
+    uint32_t pid = getpid();
+    uint32_t none;
+    int i;
+
+    if (name == NULL)
+        name = EATFT_SHM_NAME;
+
+    if ((shm = shm_map(name, O_RDWR)) == NULL)
+        return ERROR;
+
+    if (shm->magic != EATFT_SHM_MAGIC) {
+        fprintf(stderr, "ERROR: %s is not served by eatftd\n", name);
+        munmap(shm, sizeof(*shm));
+        return ERROR;
+    }
+
+    for (i = 0; i < EATFT_SHM_CLIENTS; i++) {
+        none = 0;
+        if (__atomic_compare_exchange_n(&shm->clients[i].pid, &none, pid,
+                                        false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_RELAXED))
+            break;
+    }
+
+    if (i == EATFT_SHM_CLIENTS) {
+        fprintf(stderr, "ERROR: all %d display slots taken\n", i);
+        munmap(shm, sizeof(*shm));
+        return ERROR;
+    }
+
+    priv = calloc(1, sizeof(struct shm_driver));
+
+    if (priv == NULL) {
+        fprintf(stderr, "ERROR: failed to allocate shm_driver\n");
+        STORE(&shm->clients[i].pid, 0);
+        munmap(shm, sizeof(*shm));
+        return ERROR;
+    }
+
+    /* events of the previous owner are stale */
+    c = &shm->clients[i];
+    STORE(&c->ev_tail, LOAD(&c->ev_head));
+
+    priv->shm = shm;
+    priv->slot = c;
+
+    eatft_init(tft);
+    eatft_code_base(tft, (i + 1) * EATFT_SHM_CODES);
+
+    tft->driver = priv;
+    tft->transmit = shm_transmit;
+    tft->receive = shm_receive;
+    tft->ready = shm_ready;
+    tft->clock = eatft_unix_clock;
+
+    return OK;
+}
+
+void eatft_shm_wait(struct eatft *tft, uint32_t timeout_us)
+{
+    struct shm_driver *priv = tft->driver;
+    struct eatft_shm_client *c = priv->slot;
+    uint32_t seq = LOAD(&c->ev_seq);
+
+    if (LOAD(&c->ev_head) == c->ev_tail)
+        shm_futex_wait(&c->ev_seq, seq, timeout_us);
+
+    /* fetch them with the next poll rather than the next interval */
+    if (LOAD(&c->ev_head) != c->ev_tail)
+        eatft_poll_kick(tft);
+}
+
+int eatft_shm_free(struct eatft *tft)
+{
+    struct shm_driver *priv = tft->driver;
+
+    STORE(&priv->slot->pid, 0);
+    munmap(priv->shm, sizeof(*priv->shm));
+    free(priv);
+    tft->driver = NULL;
+
+    return OK;
+}
+
+/* daemon */
+
+struct eatft_shm *eatft_shm_server_create(const char *name)
+{
+    struct eatft_shm *shm;
+
+    if ((shm = shm_map(name ? name : EATFT_SHM_NAME, O_RDWR | O_CREAT)) == NULL)
+        return NULL;
+
+    memset(shm, 0, sizeof(*shm));
+    STORE(&shm->magic, EATFT_SHM_MAGIC);
+
+    return shm;
+}
+
+/* takes the next packet of a client, returns its length or 0 */
+static uint8_t shm_server_take(struct eatft_shm_client *c, uint8_t *buf)
+{
+    uint32_t head = LOAD(&c->cmd_head);
+    uint32_t tail = c->cmd_tail;
+    uint8_t len;
+    uint8_t i;
+
+    if (head == tail)
+        return 0;
+
+    len = c->ring[tail++ & RING_MASK];
+    for (i = 0; i < len; i++)
+        buf[i] = c->ring[tail++ & RING_MASK];
+
+    STORE(&c->cmd_tail, tail);
+
+    if (LOAD(&c->cmd_waiting)) {
+        STORE(&c->cmd_waiting, 0);
+        shm_futex_wake(&c->cmd_tail);
+    }
+
+    return len;
+}
+
+/**
+ * Appends client packets round robin until the rings are empty or limit
+ * bytes have been taken. Returns the number of bytes taken.
+ */
+uint16_t eatft_shm_server_forward(struct eatft_shm *shm, struct eatft *tft,
+                                  uint16_t limit)
+{
+    uint8_t buf[255];
+    uint16_t taken = 0;
+    uint8_t len;
+    bool more;
+    int i;
+
+    do {
+        more = false;
+
+        for (i = 0; i < EATFT_SHM_CLIENTS && taken < limit; i++) {
+            /* the client after the last one served goes first */
+            len = shm_server_take(&shm->clients[shm->turn], buf);
+            shm->turn = (shm->turn + 1) % EATFT_SHM_CLIENTS;
+            if (len == 0)
+                continue;
+
+            eatft_append(tft, buf, len);
+            taken += len;
+            more = true;
+        }
+    } while (more && taken < limit);
+
+    return taken;
+}
+
+static void shm_server_push(struct eatft_shm_client *c,
+                            const struct eatft_event *ev)
+{
+    struct eatft_shm_event *dst;
+    uint32_t head = c->ev_head;
+
+    if (head - LOAD(&c->ev_tail) == EATFT_SHM_EVENTS) {
+        c->ev_dropped++;
+        return;
+    }
+
+    dst = &c->events[head & EVENTS_MASK];
+    dst->code = ev->code;
+    dst->len = ev->len;
+    memcpy(dst->data, ev->data, ev->len);
+    STORE(&c->ev_head, head + 1);
+
+    __atomic_add_fetch(&c->ev_seq, 1, __ATOMIC_RELEASE);
+    shm_futex_wake(&c->ev_seq);
+}
+
+/**
+ * Routes the records queued by the display, see eatft_events_defer().
+ * Button, switch and bar records as well as switch query answers go to
+ * the owner of their code, the rest to every client.
+ */
+void eatft_shm_server_route(struct eatft_shm *shm, struct eatft *tft)
+{
+    struct eatft_event ev;
+    int owner;
+    int i;
+
+    while (eatft_events_pop(tft, &ev)) {
+        owner = -1;
+
+        if ((ev.code == 'A' || ev.code == 'B' || ev.code == 'X')
+            && ev.len > 0)
+            owner = (ev.data[0] & 0x7f) / EATFT_SHM_CODES - 1;
+
+        for (i = 0; i < EATFT_SHM_CLIENTS; i++) {
+            if ((owner < 0 || owner == i) && LOAD(&shm->clients[i].pid))
+                shm_server_push(&shm->clients[i], &ev);
+        }
+    }
+}
+
+/* frees the slots of clients gone without eatft_shm_free() */
+void eatft_shm_server_reap(struct eatft_shm *shm, struct eatft *tft)
+{
+    struct eatft_shm_client *c;
+    uint32_t pid;
+    uint8_t code;
+    int i;
+
+    for (i = 0; i < EATFT_SHM_CLIENTS; i++) {
+        c = &shm->clients[i];
+        pid = LOAD(&c->pid);
+
+        if (pid == 0 || kill(pid, 0) == 0 || errno != ESRCH)
+            continue;
+
+        /* packets still queued are dropped */
+        STORE(&c->cmd_tail, LOAD(&c->cmd_head));
+
+        /* its buttons would report to the next owner of the slot */
+        for (code = 1; code < EATFT_SHM_CODES; code++)
+            eatft_button_undefine(tft, (i + 1) * EATFT_SHM_CODES + code);
+
+        STORE(&c->pid, 0);
+    }
+}
+
+void eatft_shm_server_wait(struct eatft_shm *shm, uint32_t seq,
+                           uint32_t timeout_us)
+{
+    shm_futex_wait(&shm->seq, seq, timeout_us);
+}
+
+void eatft_shm_server_free(struct eatft_shm *shm, const char *name)
+{
+    munmap(shm, sizeof(*shm));
+    shm_unlink(name ? name : EATFT_SHM_NAME);
+}
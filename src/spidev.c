@@ -0,0 +1,277 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#include <eatft.h>
+#include <eatft_spidev.h>
+#include <eatft_unix.h>
+
+/* undocumented pause after a packet before the ACK can be read */
+#define CONFIG_EATFT_SPIDEV_ACK_DELAY_US 10
+/**
+ * Not every SPI controller supports word delays and they are silently
+ * ignored then. Set to 0 to send every byte as its own transfer instead,
+ * still within one SPI_IOC_MESSAGE.
+ */
+#define CONFIG_EATFT_SPIDEV_WORD_DELAY 1
+#define CONFIG_EATFT_SPIDEV_RETRIES 10
+
+/* DCx, len, payload and checksum plus the ACK */
+#define SPIDEV_MAX_TRANSFERS (CONFIG_EATFT_OBUF_SIZE + 3 + 1)
+
+struct spidev_driver {
+    int fd;
+    uint32_t speed;
+    /* the controller can't shift LSB first, bits are reversed in software */
+    bool reverse;
+    eatft_spidev_ioctl_t ioctl;
+};
+
+static int spidev_ioctl(int fd, unsigned long request, void *arg)
+{
+    return ioctl(fd, request, arg);
+}
+
+static uint8_t spidev_reverse(uint8_t b)
+{
+    b = (b & 0xf0) >> 4 | (b & 0x0f) << 4;
+    b = (b & 0xcc) >> 2 | (b & 0x33) << 2;
+    b = (b & 0xaa) >> 1 | (b & 0x55) << 1;
+    return b;
+}
+
+static void spidev_fix_order(struct spidev_driver *priv, uint8_t *buf, int len)
+{
+    if (priv->reverse) {
+        while (len--) {
+            *buf = spidev_reverse(*buf);
+            buf++;
+        }
+    }
+}
+
+/* fills transfers for len bytes, returns the number of transfers used */
+static int spidev_prepare(struct spidev_driver *priv,
+                          struct spi_ioc_transfer *xfer,
+                          uint8_t *tx, uint8_t *rx, int len)
+{
+    int n = 0;
+
+#if CONFIG_EATFT_SPIDEV_WORD_DELAY
+    xfer[n].tx_buf = (uintptr_t)tx;
+    xfer[n].rx_buf = (uintptr_t)rx;
+    xfer[n].len = len;
+    xfer[n].speed_hz = priv->speed;
+    xfer[n].bits_per_word = 8;
+    xfer[n].word_delay_usecs = CONFIG_EATFT_SPI_BYTE_US;
+    n++;
+#else
+    for (; n < len; n++) {
+        xfer[n].tx_buf = tx ? (uintptr_t)(tx + n) : 0;
+        xfer[n].rx_buf = rx ? (uintptr_t)(rx + n) : 0;
+        xfer[n].len = 1;
+        xfer[n].speed_hz = priv->speed;
+        xfer[n].bits_per_word = 8;
+        xfer[n].delay_usecs = CONFIG_EATFT_SPI_BYTE_US;
+    }
+#endif
+
+    return n;
+}
+
+/**
+ * Sends the whole packet and reads the ACK with a single ioctl.
+ * The slave select is released after the packet for the ACK delay.
+ */
+static void spidev_transmit(struct eatft *tft)
+{
+    struct spidev_driver *priv = tft->driver;
+    struct spi_ioc_transfer xfer[SPIDEV_MAX_TRANSFERS];
+    uint8_t tx[CONFIG_EATFT_OBUF_SIZE + 3];
+    uint8_t ack;
+    int len = tft->olen + 3;
+    int retries = CONFIG_EATFT_SPIDEV_RETRIES;
+    int n;
+
+    memcpy(tx, &tft->dc, len);
+    spidev_fix_order(priv, tx, len);
+
+    do {
+        memset(xfer, 0, sizeof(xfer));
+
+        n = spidev_prepare(priv, xfer, tx, NULL, len);
+        xfer[n - 1].delay_usecs = CONFIG_EATFT_SPIDEV_ACK_DELAY_US;
+        xfer[n - 1].cs_change = 1;
+
+        xfer[n].rx_buf = (uintptr_t)&ack;
+        xfer[n].len = 1;
+        xfer[n].speed_hz = priv->speed;
+        xfer[n].bits_per_word = 8;
+        n++;
+
+        ack = 0;
+        if (priv->ioctl(priv->fd, SPI_IOC_MESSAGE(n), xfer) < 0) {
+            perror("SPI_IOC_MESSAGE");
+            continue;
+        }
+
+        spidev_fix_order(priv, &ack, 1);
+
+        eatft_trace(tft, ack == EATFT_ACK
+                    ? EATFT_TRACE_ACK : EATFT_TRACE_NAK, ack);
+
+    } while (ack != EATFT_ACK && --retries > 0);
+}
+
+/* header and payload, the length is only known after the header */
+static void spidev_receive(struct eatft *tft)
+{
+    struct spidev_driver *priv = tft->driver;
+    struct spi_ioc_transfer xfer[CONFIG_EATFT_IBUF_SIZE];
+    int n;
+
+    tft->ilen = 0;
+
+    memset(xfer, 0, sizeof(xfer));
+    n = spidev_prepare(priv, xfer, NULL, tft->ibuf, 2);
+
+    if (priv->ioctl(priv->fd, SPI_IOC_MESSAGE(n), xfer) < 0) {
+        perror("SPI_IOC_MESSAGE");
+        tft->ibuf[1] = 0;
+        return;
+    }
+    spidev_fix_order(priv, tft->ibuf, 2);
+
+    if (tft->ibuf[1] + 3 > CONFIG_EATFT_IBUF_SIZE) {
+        tft->ibuf[1] = 0;
+        return;
+    }
+
+    memset(xfer, 0, sizeof(xfer));
+    n = spidev_prepare(priv, xfer, NULL, tft->ibuf + 2, tft->ibuf[1] + 1);
+
+    if (priv->ioctl(priv->fd, SPI_IOC_MESSAGE(n), xfer) < 0) {
+        perror("SPI_IOC_MESSAGE");
+        tft->ibuf[1] = 0;
+        return;
+    }
+    spidev_fix_order(priv, tft->ibuf + 2, tft->ibuf[1] + 1);
+
+    tft->ilen = tft->ibuf[1] + 3;
+}
+
+static bool spidev_ready(struct eatft *tft)
+{
+    (void)tft;
+
+    /* transfers are blocking */
+    return true;
+}
+
+static int spidev_setup(struct spidev_driver *priv)
+{
+    uint8_t mode = SPI_MODE_3;
+    uint8_t lsb = 1;
+    uint8_t bits = 8;
+
+    if (priv->ioctl(priv->fd, SPI_IOC_WR_MODE, &mode) < 0
+        || priv->ioctl(priv->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0
+        || priv->ioctl(priv->fd, SPI_IOC_WR_MAX_SPEED_HZ, &priv->speed) < 0) {
+        perror("spidev");
+        return ERROR;
+    }
+
+    /* the display shifts LSB first */
+    priv->reverse = priv->ioctl(priv->fd, SPI_IOC_WR_LSB_FIRST, &lsb) < 0;
+
+    return OK;
+}
+
+int eatft_spidev_create_fd(struct eatft *tft, int fd, uint32_t speed,
+                           eatft_spidev_ioctl_t fun)
+{
+    struct spidev_driver *priv;
+
+    eatft_init(tft);
+
+    priv = calloc(1, sizeof(struct spidev_driver));
+
+    if (priv == NULL) {
+        fprintf(stderr, "ERROR: failed to allocate spidev_driver\n");
+        return ERROR;
+    }
+
+    priv->fd = fd;
+    priv->speed = speed;
+    priv->ioctl = fun ? fun : spidev_ioctl;
+
+    if (spidev_setup(priv) != OK) {
+        free(priv);
+        return ERROR;
+    }
+
+    tft->driver = priv;
+    tft->transmit = spidev_transmit;
+    tft->receive = spidev_receive;
+    tft->ready = spidev_ready;
+    tft->clock = eatft_unix_clock;
+
+    return OK;
+}
+
+int eatft_spidev_create(struct eatft *tft, const char *dev, uint32_t speed)
+{
+    int fd;
+
+    if ((fd = open(dev, O_RDWR)) < 0) {
+        perror(dev);
+        return ERROR;
+    }
+
+    if (eatft_spidev_create_fd(tft, fd, speed, NULL) != OK) {
+        close(fd);
+        return ERROR;
+    }
+
+    return OK;
+}
+
+int eatft_spidev_free(struct eatft *tft)
+{
+    struct spidev_driver *priv = tft->driver;
+
+    close(priv->fd);
+    free(priv);
+    tft->driver = NULL;
+
+    return OK;
+}
@@ -25,7 +25,8 @@
 
 #include <stdarg.h>
 #include <stdlib.h>
-#include <eatft.h>
+
+#include "private.h"
 
 #define CONFIG_EATFT_SWITCH_HEIGHT 50
 
@@ -34,22 +35,16 @@ struct eatft_widget *eatft_wdt_switch_vcreatei(
     eatft_callback_t callback, void *priv, enum eatft_align align,
     const char *fmt, va_list args)
 {
-    struct eatft_widget *wdt = NULL;
+    struct eatft_widget *wdt;
     int i;
 
-    /* search switchs from front to back */
-    for (i = 0; i < CONFIG_EATFT_MAX_WIDGETS; i++) {
-        if (tft->widgets[i].fun == NULL) {
-            wdt = &tft->widgets[i];
-            break;
-        }
-    }
+    wdt = eatft_wdt_alloc(tft, EATFT_WDT_SWITCH);
 
     if (wdt) {
         wdt->fun = callback;
         wdt->priv = priv;
         /* event 0 means disabled, so we start from 1 */
-        i++;
+        i = eatft_wdt_code(tft, wdt);
         eatft_switch_vcreatei(tft, x, y, width, height,
                               i | 0x80, i, align, fmt, args);
         eatft_flush(tft);
@@ -125,6 +120,6 @@ struct eatft_widget *eatft_wdt_switch_createw(
 void eatft_wdt_switch_set(struct eatft *tft, struct eatft_widget *widget,
                           bool enable)
 {
-    eatft_switch_set(tft, widget - tft->widgets + 1, enable);
+    eatft_switch_set(tft, eatft_wdt_code(tft, widget), enable);
     eatft_flush(tft);
 }
@@ -0,0 +1,165 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __AVR__
+#  include <util/atomic.h>
+#endif
+
+#include "private.h"
+
+#define TRACE_MASK (CONFIG_EATFT_TRACE_SIZE - 1)
+
+#if CONFIG_EATFT_TRACE_SIZE > 0
+
+/* cheap enough for hot paths and interrupts, older entries get overwritten */
+void eatft_trace_record(struct eatft *tft, uint8_t event, uint8_t arg)
+{
+    struct eatft_trace_entry entry;
+
+    entry.time = eatft_clock(tft);
+    entry.event = event;
+    entry.arg = arg;
+
+#ifdef __AVR__
+    /* records are also taken from the SPI and timer interrupts */
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+    {
+        tft->trace[tft->trace_head & TRACE_MASK] = entry;
+        tft->trace_head++;
+    }
+}
+
+/* copies the ring from the oldest to the newest entry */
+uint8_t eatft_trace_copy(struct eatft *tft, struct eatft_trace_entry *entries,
+                         uint8_t max)
+{
+    uint8_t head = tft->trace_head;
+    uint8_t n = 0;
+    uint16_t i;
+
+    for (i = 0; i < CONFIG_EATFT_TRACE_SIZE && n < max; i++) {
+        entries[n] = tft->trace[(head + i) & TRACE_MASK];
+
+        /* skip slots never written */
+        if (entries[n].event != 0)
+            n++;
+    }
+
+    return n;
+}
+
+static void eatft_latency_add(struct eatft_latency *lat, uint32_t start,
+                              uint32_t end)
+{
+    uint32_t d = end - start;
+
+    if (lat->count == 0 || d < lat->min)
+        lat->min = d;
+    if (d > lat->max)
+        lat->max = d;
+
+    lat->sum += d;
+    lat->count++;
+}
+
+/**
+ * A touch can only be seen with the next poll, so touch to callback is
+ * measured from the poll request to the return of the first widget
+ * callback of the frame. It is split into the link part poll to frame and
+ * the processing part frame to callback.
+ */
+void eatft_trace_analyze(struct eatft *tft, struct eatft_trace_stats *stats)
+{
+    struct eatft_trace_entry entries[CONFIG_EATFT_TRACE_SIZE];
+    struct eatft_trace_entry *e;
+    uint32_t flush = 0, poll = 0, rx = 0;
+    bool flushed = false, polled = false, received = false;
+    uint8_t n, i;
+
+    memset(stats, 0, sizeof(*stats));
+    n = eatft_trace_copy(tft, entries, CONFIG_EATFT_TRACE_SIZE);
+
+    for (i = 0; i < n; i++) {
+        e = &entries[i];
+
+        switch (e->event) {
+        case EATFT_TRACE_FLUSH:
+            flush = e->time;
+            flushed = true;
+            break;
+
+        case EATFT_TRACE_ACK:
+            if (flushed)
+                eatft_latency_add(&stats->flush_to_ack, flush, e->time);
+            flushed = false;
+            break;
+
+        case EATFT_TRACE_POLL:
+            poll = e->time;
+            polled = true;
+            received = false;
+            break;
+
+        case EATFT_TRACE_RX:
+            if (polled)
+                eatft_latency_add(&stats->poll_to_rx, poll, e->time);
+            rx = e->time;
+            received = polled;
+            break;
+
+        case EATFT_TRACE_CALLBACK:
+            /* only the first callback of a frame counts */
+            if (received) {
+                eatft_latency_add(&stats->rx_to_callback, rx, e->time);
+                eatft_latency_add(&stats->touch_to_callback, poll, e->time);
+            }
+            received = false;
+            break;
+        }
+    }
+}
+
+#else
+
+void eatft_trace_record(struct eatft *tft, uint8_t event, uint8_t arg)
+{
+}
+
+uint8_t eatft_trace_copy(struct eatft *tft, struct eatft_trace_entry *entries,
+                         uint8_t max)
+{
+    return 0;
+}
+
+void eatft_trace_analyze(struct eatft *tft, struct eatft_trace_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
@@ -23,58 +23,166 @@
  * THE SOFTWARE.
  */
 
+#define _GNU_SOURCE
+
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 
 #include <eatft.h>
+#include <eatft_capture.h>
+#include <eatft_unix.h>
 
-#define CONFIG_EATFT_PORT "/dev/ttyS0"
 #define CONFIG_EATFT_BAUD B115200
 #define CONFIG_EATFT_TIMEOUT 1000
 
 struct unix_driver {
     struct eatft *tft;
     int fd;
+    /* pty slave kept open, the master reports EIO without one */
+    int slave;
+    /* serial port or pty, a read of 0 is a timeout there and not EOF */
+    bool tty;
+    /* written with send() to avoid SIGPIPE from a closed peer */
+    bool socket;
+    struct eatft_capture capture;
 };
 
 static void unix_receive(struct eatft *tft);
 static void unix_transmit(struct eatft *tft);
 static bool unix_data_ready(struct eatft *tft);
 
+static void unix_capture(struct eatft *tft, uint8_t type,
+                         const uint8_t *data, uint8_t len)
+{
+    struct unix_driver *priv = tft->driver;
+
+    if (priv->capture.file)
+        eatft_capture_write(&priv->capture, type, eatft_unix_clock(tft),
+                            data, len);
+}
+
+/* sockets and ptys may return partial reads, serial ports time out */
+static int unix_read(int fd, uint8_t *buf, int len)
+{
+    int done = 0;
+    int n;
+
+    while (done < len && (n = read(fd, buf + done, len - done)) > 0)
+        done += n;
+
+    return done;
+}
+
+static bool unix_retry(void)
+{
+    return errno == EINTR || errno == EAGAIN;
+}
+
+/* returns ERROR once the other end is gone */
+static int unix_write(struct unix_driver *priv, const uint8_t *buf, int len)
+{
+    int done = 0;
+    int n;
+
+    while (done < len) {
+        if (priv->socket)
+            n = send(priv->fd, buf + done, len - done, MSG_NOSIGNAL);
+        else
+            n = write(priv->fd, buf + done, len - done);
+
+        if (n > 0)
+            done += n;
+        else if (n == 0 || !unix_retry())
+            return ERROR;
+    }
+
+    return OK;
+}
 
 static void unix_receive(struct eatft *tft)
 {
     struct unix_driver *priv = tft->driver;
-    int n;
 
     /* read header */
-    n = read(priv->fd, tft->ibuf, 2);
+    if (unix_read(priv->fd, tft->ibuf, 2) != 2
+        || tft->ibuf[1] + 3 > CONFIG_EATFT_IBUF_SIZE) {
+        tft->ibuf[1] = 0;
+        tft->ilen = 0;
+        return;
+    }
+
     /* read len + checksum */
-    read(priv->fd, tft->ibuf + 2, tft->ibuf[1] + 1);
+    unix_read(priv->fd, tft->ibuf + 2, tft->ibuf[1] + 1);
     tft->ilen = tft->ibuf[1] + 3;
+
+    unix_capture(tft, EATFT_CAPTURE_RX, tft->ibuf, tft->ilen);
 }
 
 static void unix_transmit(struct eatft *tft)
 {
     struct unix_driver *priv = tft->driver;
+    uint32_t sent;
+    uint32_t latency;
     uint8_t ack;
     int n;
-    int i;
 
     do {
-        /* printf("Write: %d\n", tft->olen); */
-        /* for (i = 0; i < tft->olen + 3; i++) */
-        /*     printf("%02x ", (&tft->dc)[i]); */
-        /* printf("\n"); */
+        unix_capture(tft, EATFT_CAPTURE_TX, &tft->dc, tft->olen + 3);
+        if (unix_write(priv, &tft->dc, tft->olen + 3) != OK)
+            goto closed;
+
+        /* wait until the packet left the UART to measure the ACK latency */
+        if (priv->tty)
+            tcdrain(priv->fd);
+        sent = eatft_unix_clock(tft);
 
-        write(priv->fd, &tft->dc, tft->olen + 3);
         n = read(priv->fd, &ack, 1);
-        /* printf("response len: %d, ack: %02x\n", n, ack); */
+
+        if (n > 0) {
+            unix_capture(tft, ack == EATFT_ACK
+                         ? EATFT_CAPTURE_ACK : EATFT_CAPTURE_NAK, &ack, 1);
+            eatft_trace(tft, ack == EATFT_ACK
+                        ? EATFT_TRACE_ACK : EATFT_TRACE_NAK, ack);
+        } else if ((n == 0 && !priv->tty) || (n < 0 && !unix_retry())) {
+            goto closed;
+        } else if (n == 0) {
+            /* no ACK in time, mark the resend for the replay */
+            unix_capture(tft, EATFT_CAPTURE_NAK, NULL, 0);
+        }
 
     } while (n <= 0 || ack != EATFT_ACK);
+
+    latency = eatft_unix_clock(tft) - sent;
+    if (latency > UINT16_MAX)
+        latency = UINT16_MAX;
+
+    /* moving average over ~8 packets for the cost model */
+    tft->ack_us = (tft->ack_us * 7 + latency) / 8;
+    return;
+
+closed:
+    /* the packet is dropped, no response is waited for */
+    fprintf(stderr, "ERROR: display connection closed\n");
+    tft->next_state = EATFT_RESET;
+}
+
+uint32_t eatft_unix_clock(struct eatft *tft)
+{
+    (void)tft;
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
 }
 
 static bool unix_ready(struct eatft *tft)
@@ -83,30 +191,46 @@ static bool unix_ready(struct eatft *tft)
     return true;
 }
 
-int eatft_unix_create(struct eatft *tft, const char *dev)
+/**
+ * Attaches the driver to any connected stream, all transports share the
+ * same transmit, receive and ready implementation.
+ */
+static int unix_attach(struct eatft *tft, int fd, int slave)
 {
-    int ret = OK;
     struct unix_driver *priv;
-    struct termios tio;
+    struct stat st;
 
     eatft_init(tft);
 
     priv = calloc(1, sizeof(struct unix_driver));
 
-    if (priv) {
-        memset(priv, 0, sizeof(*priv));
-    } else {
+    if (priv == NULL) {
         fprintf(stderr, "ERROR: failed to allocate unix_driver\n");
-        ret = ERROR;
+        return ERROR;
     }
 
-    if (ret == OK
-        && (priv->fd = open(dev, O_RDWR | O_NOCTTY)) > 0) {
+    priv->tft = tft;
+    priv->fd = fd;
+    priv->slave = slave;
+    priv->tty = isatty(fd);
+    priv->socket = fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode);
+
+    tft->driver = priv;
+    tft->receive = unix_receive;
+    tft->transmit = unix_transmit;
+    tft->ready = unix_ready;
+    tft->clock = eatft_unix_clock;
+
+    return OK;
+}
+
+int eatft_unix_create(struct eatft *tft, const char *dev)
+{
+    int ret = OK;
+    struct termios tio;
+    int fd;
 
-        tft->driver = priv;
-        tft->receive = unix_receive;
-        tft->transmit = unix_transmit;
-        tft->ready = unix_ready;
+    if ((fd = open(dev, O_RDWR | O_NOCTTY)) > 0) {
 
         memset(&tio, 0, sizeof(tio));
         tio.c_cflag = CS8 | CREAD | CLOCAL;
@@ -119,23 +243,131 @@ int eatft_unix_create(struct eatft *tft, const char *dev)
             ret = ERROR;
 
         }
-        if(ret == OK && tcsetattr(priv->fd, TCSANOW, &tio) < 0) {
+        if(ret == OK && tcsetattr(fd, TCSANOW, &tio) < 0) {
             fprintf(stderr, "ERROR: failed to setup serial port\n");
             ret = ERROR;
         }
 
     } else {
-        perror(CONFIG_EATFT_PORT);
+        perror(dev);
         ret = ERROR;
     }
 
+    if (ret == OK)
+        ret = unix_attach(tft, fd, -1);
+
+    if (ret != OK && fd > 0)
+        close(fd);
+
     return ret;
 }
 
+int eatft_unix_create_fd(struct eatft *tft, int fd)
+{
+    return unix_attach(tft, fd, -1);
+}
+
+int eatft_unix_connect(struct eatft *tft, const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        perror("socket");
+        return ERROR;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || unix_attach(tft, fd, -1) != OK) {
+        perror(path);
+        close(fd);
+        return ERROR;
+    }
+
+    return OK;
+}
+
+int eatft_unix_socketpair(struct eatft *tft, int *peer)
+{
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        perror("socketpair");
+        return ERROR;
+    }
+
+    if (unix_attach(tft, fds[0], -1) != OK) {
+        close(fds[0]);
+        close(fds[1]);
+        return ERROR;
+    }
+
+    *peer = fds[1];
+    return OK;
+}
+
+int eatft_unix_openpty(struct eatft *tft, char *name, size_t size)
+{
+    struct termios tio;
+    int master;
+    int slave = -1;
+
+    if ((master = posix_openpt(O_RDWR | O_NOCTTY)) < 0
+        || grantpt(master) < 0
+        || unlockpt(master) < 0
+        || ptsname_r(master, name, size) != 0
+        || (slave = open(name, O_RDWR | O_NOCTTY)) < 0) {
+        perror("pty");
+        goto error;
+    }
+
+    /* the peer expects the raw byte stream */
+    if (tcgetattr(slave, &tio) < 0) {
+        perror(name);
+        goto error;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    if (unix_attach(tft, master, slave) == OK)
+        return OK;
+
+error:
+    if (slave >= 0)
+        close(slave);
+    if (master >= 0)
+        close(master);
+    return ERROR;
+}
+
+int eatft_unix_capture(struct eatft *tft, const char *path)
+{
+    struct unix_driver *priv = tft->driver;
+
+    eatft_capture_close(&priv->capture);
+
+    if (path == NULL)
+        return OK;
+
+    return eatft_capture_open(&priv->capture, path);
+}
+
 int eatft_unix_free(struct eatft *tft)
 {
     struct unix_driver *priv = tft->driver;
 
+    eatft_capture_close(&priv->capture);
     close(priv->fd);
+    if (priv->slave >= 0)
+        close(priv->slave);
     free(tft->driver);
+
+    return OK;
 }
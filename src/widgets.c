@@ -39,77 +39,201 @@ static bool eatft_is_in_rect(const struct eatft_rect *rect, int x, int y)
         && (y <= (rect->y + rect->height));
 }
 
-static void eatft_touch_dispatch(struct eatft *tft)
+/* returns the area index or -1, areas created first take precedence */
+static int eatft_touch_find(struct eatft *tft, uint16_t x, uint16_t y)
+{
+    struct eatft_rect rect;
+    int i;
+
+    for (i = 0; i < CONFIG_EATFT_MAX_AREAS; i++) {
+        rect = tft->areas[i].rect;
+        if (tft->areas[i].widget && eatft_is_in_rect(&rect, x, y))
+            return i;
+    }
+
+    return -1;
+}
+
+/* returns the drag entry of an area or -1 */
+static int eatft_drag_find(struct eatft *tft, uint8_t area)
 {
-    struct eatft_widget *wdt = NULL;
-    bool down = false;
-    uint16_t x, y;
     int i;
 
+    for (i = 0; i < CONFIG_EATFT_MAX_DRAGS; i++) {
+        if (tft->drags[i].area == area + 1)
+            return i;
+    }
+
+    return -1;
+}
+
+static void eatft_touch_deliver(struct eatft *tft, uint8_t drag)
+{
+    struct eatft_drag d = tft->drags[drag];
+    uint8_t slot = tft->areas[d.area - 1].widget - 1;
+
+    if (d.moved) {
+        tft->drags[drag].moved = false;
+        d.fun(tft, &tft->widgets[slot], EATFT_TOUCH_MOVE, d.pos.x, d.pos.y);
+        eatft_trace(tft, EATFT_TRACE_CALLBACK, slot);
+    }
+}
+
+static void eatft_touch_dispatch(struct eatft *tft, const uint8_t *data,
+                                 uint8_t len)
+{
+    struct eatft_widget *wdt;
+    eatft_touch_callback_t fun;
+    int area, drag;
+    uint8_t phase;
+    uint8_t slot;
+    uint16_t x, y;
+
     /* for any odd reason, there are sometimes short packages */
-    if (tft->ibuf[1] != 8)
+    if (len != 5)
         return;
 
-    switch (tft->ibuf[5]) {
-    case 0:
-        down = false;
-        break;
-    case 1:
-        down = true;
-        break;
-    case 2:
-        /* down repead */
+    phase = data[0];
+    x = data[1] | data[2] << 8;
+    y = data[3] | data[4] << 8;
+
+    /* moves and releases belong to the area the touch went down in */
+    area = tft->grab - 1;
+    if (area < 0 || phase == EATFT_TOUCH_DOWN)
+        area = eatft_touch_find(tft, x, y);
+
+    if (area < 0) {
+        dbg("WARNING: unregistered touch event\n");
         return;
     }
 
-    x = tft->ibuf[6] | tft->ibuf[7] << 8;
-    y = tft->ibuf[8] | tft->ibuf[9] << 8;
+    slot = tft->areas[area].widget - 1;
+    wdt = &tft->widgets[slot];
+    drag = eatft_drag_find(tft, area);
 
-    wdt = NULL;
-    /* search areas from back to front */
-    for (i = CONFIG_EATFT_MAX_WIDGETS - 1; i >= 0; i--) {
-        if (eatft_is_in_rect(&tft->widgets[i].rect, x, y)) {
-            wdt = &tft->widgets[i];
-            break;
+    if (drag < 0) {
+        /* plain touch areas only know down and up */
+        if (phase != EATFT_TOUCH_MOVE) {
+            wdt->fun(tft, wdt, phase == EATFT_TOUCH_DOWN);
+            eatft_trace(tft, EATFT_TRACE_CALLBACK, slot);
         }
+        return;
     }
 
-    if (wdt) {
-        wdt->fun(tft, wdt, down);
-    } else {
-        dbg("WARNING: unregistered touch event\n");
+    switch (phase) {
+    case EATFT_TOUCH_DOWN:
+        tft->grab = area + 1;
+        tft->drags[drag].moved = false;
+        tft->drags[drag].fun(tft, wdt, EATFT_TOUCH_DOWN, x, y);
+        eatft_trace(tft, EATFT_TRACE_CALLBACK, slot);
+        break;
+
+    case EATFT_TOUCH_MOVE:
+        /* coalesce, delivered at the end of the frame */
+        tft->drags[drag].pos.x = x;
+        tft->drags[drag].pos.y = y;
+        tft->drags[drag].moved = true;
+        break;
+
+    case EATFT_TOUCH_UP:
+        tft->grab = 0;
+        eatft_touch_deliver(tft, drag);
+
+        /* the move callback may have freed the area */
+        fun = tft->drags[drag].fun;
+        if (fun) {
+            fun(tft, wdt, EATFT_TOUCH_UP, x, y);
+            eatft_trace(tft, EATFT_TRACE_CALLBACK, slot);
+        }
+        break;
     }
 }
 
-static void eatft_button_dispatch(struct eatft *tft)
+static void eatft_button_dispatch(struct eatft *tft, const uint8_t *data,
+                                  uint8_t len)
 {
     struct eatft_widget *wdt = NULL;
     bool down;
-    uint8_t btn = tft->ibuf[5];
+    uint8_t btn;
+
+    if (len < 1)
+        return;
 
+    btn = data[0];
     down = btn & 0x80;
-    btn = (btn & 0x7f) - 1;
+    btn = (btn & 0x7f) - 1 - tft->code_base;
 
     if (btn < CONFIG_EATFT_MAX_WIDGETS
         && (wdt = &tft->widgets[btn])->fun != NULL) {
         wdt->fun(tft, wdt, down);
+        eatft_trace(tft, EATFT_TRACE_CALLBACK, btn);
     } else {
         dbg("WARNING: unregistered touch event\n");
     }
 }
 
-void eatft_dispatch_event(struct eatft *tft)
+static void eatft_bar_dispatch(struct eatft *tft, const uint8_t *data,
+                               uint8_t len)
 {
-    switch (tft->ibuf[3]) {
+    struct eatft_widget *wdt = NULL;
+    uint8_t bar;
+
+    if (len < 2)
+        return;
+
+    bar = data[0] - 1 - tft->code_base;
+
+    if (bar < CONFIG_EATFT_MAX_WIDGETS
+        && (wdt = &tft->widgets[bar])->type == EATFT_WDT_BAR) {
+        wdt->aux = data[1];
+        if (wdt->fun) {
+            wdt->fun(tft, wdt, true);
+            eatft_trace(tft, EATFT_TRACE_CALLBACK, bar);
+        }
+    } else {
+        dbg("WARNING: unregistered bar event\n");
+    }
+}
+
+static void eatft_record_dispatch(struct eatft *tft, uint8_t code,
+                                  const uint8_t *data, uint8_t len)
+{
+    switch (code) {
     case 'A':
         /* touch button event */
-        eatft_button_dispatch(tft);
+        eatft_button_dispatch(tft, data, len);
         break;
     case 'H':
         /* free touch area pressed */
-        eatft_touch_dispatch(tft);
+        eatft_touch_dispatch(tft, data, len);
         break;
+    case 'B':
+        /* touch bar graph adjusted */
+        eatft_bar_dispatch(tft, data, len);
+        break;
+    }
+}
+
+void eatft_dispatch_record(struct eatft *tft, uint8_t code,
+                           const uint8_t *data, uint8_t len)
+{
+    eatft_trace(tft, EATFT_TRACE_DISPATCH, code);
+
+    /* responses to queries take precedence over widget events */
+    if (!eatft_query_dispatch(tft, code, data, len))
+        eatft_record_dispatch(tft, code, data, len);
+
+    eatft_trace(tft, EATFT_TRACE_DISPATCHED, code);
+}
+
+void eatft_dispatch_end(struct eatft *tft)
+{
+    int i;
 
+    /* deliver the latest position of each moved drag area */
+    for (i = 0; i < CONFIG_EATFT_MAX_DRAGS; i++) {
+        if (tft->drags[i].area)
+            eatft_touch_deliver(tft, i);
     }
 
     /* propagate that a user action has happened */
@@ -118,34 +242,108 @@ void eatft_dispatch_event(struct eatft *tft)
         tft->user_action(tft);
 }
 
-struct eatft_widget *eatft_wdt_touch_createi(
-    struct eatft *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
-    eatft_callback_t callback, void *priv)
+/**
+ * A frame from the send buffer may carry several records of the form
+ * ESC code len data[len].
+ */
+void eatft_dispatch_event(struct eatft *tft)
+{
+    const uint8_t *p = tft->ibuf + 2;
+    const uint8_t *end = p + tft->ibuf[1];
+    bool queued = false;
+
+    while (end - p >= 3 && p[0] == 0x1b && end - p >= 3 + p[2]) {
+        if (eatft_events_push(tft, p[1], p + 3, p[2]))
+            queued = true;
+        else
+            eatft_dispatch_record(tft, p[1], p + 3, p[2]);
+
+        p += 3 + p[2];
+    }
+
+    if (!queued)
+        eatft_dispatch_end(tft);
+}
+
+/**
+ * Buttons and switches are searched front to back, their slot index is
+ * used as touch code which must stay below 0x80.
+ * Bars, touch and drag areas are searched back to front.
+ */
+struct eatft_widget *eatft_wdt_alloc(struct eatft *tft, uint8_t type)
 {
     struct eatft_widget *wdt = NULL;
     int i;
 
-    for (i = CONFIG_EATFT_MAX_WIDGETS - 1; i >= 0; i--)
-        if (tft->widgets[i].fun == NULL) {
-            wdt = &tft->widgets[i];
-            break;
-        }
+    if (type == EATFT_WDT_BUTTON || type == EATFT_WDT_SWITCH) {
+        for (i = 0; i < CONFIG_EATFT_MAX_WIDGETS; i++)
+            if (tft->widgets[i].type == EATFT_WDT_FREE) {
+                wdt = &tft->widgets[i];
+                break;
+            }
+    } else {
+        for (i = CONFIG_EATFT_MAX_WIDGETS - 1; i >= 0; i--)
+            if (tft->widgets[i].type == EATFT_WDT_FREE) {
+                wdt = &tft->widgets[i];
+                break;
+            }
+    }
 
     DEBUG_ASSERT(wdt);
 
+    if (wdt)
+        wdt->type = type;
+
+    return wdt;
+}
+
+static struct eatft_widget *eatft_wdt_area_createi(
+    struct eatft *tft, uint8_t type, uint16_t x, uint16_t y,
+    uint16_t width, uint16_t height)
+{
+    struct eatft_widget *wdt;
+    struct eatft_area area;
+    int i;
+
+    for (i = 0; i < CONFIG_EATFT_MAX_AREAS; i++)
+        if (tft->areas[i].widget == 0)
+            break;
+
+    /* the table is smaller than the widget slots, not a bug */
+    if (i == CONFIG_EATFT_MAX_AREAS)
+        return NULL;
+
+    wdt = eatft_wdt_alloc(tft, type);
+
     if (wdt) {
         /* create touch area */
         eatft_touch_areai(tft, x, y, width, height);
         eatft_flush(tft);
 
+        area.rect.x = x;
+        area.rect.y = y;
+        area.rect.width = width;
+        area.rect.height = height;
+        area.widget = wdt - tft->widgets + 1;
+        tft->areas[i] = area;
+        wdt->aux = i;
+    }
+
+    return wdt;
+}
+
+struct eatft_widget *eatft_wdt_touch_createi(
+    struct eatft *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+    eatft_callback_t callback, void *priv)
+{
+    struct eatft_widget *wdt;
+
+    wdt = eatft_wdt_area_createi(tft, EATFT_WDT_TOUCH, x, y, width, height);
+
+    if (wdt) {
         /* register callback */
         wdt->fun = callback;
         wdt->priv = priv;
-
-        wdt->rect.x = x;
-        wdt->rect.y = y;
-        wdt->rect.width = width;
-        wdt->rect.height = height;
     }
 
     return wdt;
@@ -160,19 +358,103 @@ struct eatft_widget *eatft_wdt_touch_creater(
     return eatft_wdt_touch_createi(tft, r.x, r.y, r.width, r.height, callback, priv);
 }
 
-void eatft_wdt_free(struct eatft *tft, struct eatft_widget *widget)
+struct eatft_widget *eatft_wdt_drag_createi(
+    struct eatft *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+    eatft_touch_callback_t callback, void *priv)
 {
-    struct eatft_rect *r;
-    if (widget != NULL) {
-        if (widget->rect.width == 0 && widget->rect.height == 0) {
-            eatft_button_remove(tft, widget - tft->widgets + 1);
-        } else {
-            r = &widget->rect;
-            eatft_touch_area_removei(tft, r->x, r->y, r->width, r->height);
+    struct eatft_widget *wdt;
+    struct eatft_drag drag;
+    int i;
+
+    for (i = 0; i < CONFIG_EATFT_MAX_DRAGS; i++)
+        if (tft->drags[i].area == 0)
+            break;
+
+    if (i == CONFIG_EATFT_MAX_DRAGS)
+        return NULL;
+
+    wdt = eatft_wdt_area_createi(tft, EATFT_WDT_DRAG, x, y, width, height);
+
+    if (wdt) {
+        /* register callback */
+        drag.fun = callback;
+        drag.pos.x = 0;
+        drag.pos.y = 0;
+        drag.moved = false;
+        drag.area = wdt->aux + 1;
+        tft->drags[i] = drag;
+        wdt->priv = priv;
+    }
+
+    return wdt;
+}
+
+struct eatft_widget *eatft_wdt_drag_creater(
+    struct eatft *tft, const struct eatft_rect *rect,
+    eatft_touch_callback_t callback, void *priv)
+{
+    struct eatft_rect r;
+    memcpy_P(&r, rect, sizeof(r));
+    return eatft_wdt_drag_createi(tft, r.x, r.y, r.width, r.height, callback, priv);
+}
+
+/* queues the removal and frees the slot, the caller flushes */
+void eatft_wdt_release(struct eatft *tft, struct eatft_widget *widget)
+{
+    struct eatft_rect r;
+    uint8_t area;
+    int drag;
+
+    /* aux of a free slot is no area index */
+    if (widget->type == EATFT_WDT_FREE)
+        return;
+
+    if (widget->type == EATFT_WDT_BUTTON
+        || widget->type == EATFT_WDT_SWITCH) {
+        eatft_button_remove(tft, eatft_wdt_code(tft, widget));
+    } else if (widget->type == EATFT_WDT_BAR) {
+        eatft_bar_remove(tft, eatft_wdt_code(tft, widget));
+    } else {
+        area = widget->aux;
+        r = tft->areas[area].rect;
+        eatft_touch_area_removei(tft, r.x, r.y, r.width, r.height);
+
+        if (tft->grab == area + 1)
+            tft->grab = 0;
+
+        drag = eatft_drag_find(tft, area);
+        if (drag >= 0) {
+            tft->drags[drag].fun = NULL;
+            tft->drags[drag].area = 0;
         }
+        tft->areas[area].widget = 0;
+    }
+
+    /* mark slot as free */
+    memset(widget, 0, sizeof(*widget));
+}
+
+/* code the display knows the widget by, 0 is invalid so codes start at 1 */
+uint8_t eatft_wdt_code(const struct eatft *tft,
+                       const struct eatft_widget *widget)
+{
+    return tft->code_base + (widget - tft->widgets) + 1;
+}
 
-        /* mark slot as free */
-        memset(widget, 0, sizeof(*widget));
+/**
+ * Offsets the codes of buttons, switches and bars, so that several
+ * instances can share one display without their events colliding.
+ */
+void eatft_code_base(struct eatft *tft, uint8_t base)
+{
+    DEBUG_ASSERT(base + CONFIG_EATFT_MAX_WIDGETS < 0x80);
+    tft->code_base = base;
+}
+
+void eatft_wdt_free(struct eatft *tft, struct eatft_widget *widget)
+{
+    if (widget != NULL) {
+        eatft_wdt_release(tft, widget);
 
         /* flush after freeing to prevent further callback calls */
         eatft_flush(tft);
@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <eatft.h>
+#include <eatft_layout.h>
 
 #include "test.h"
 
@@ -38,21 +39,15 @@
 #define BUTTONS_HEIGHT (CONFIG_EATFT_HEIGHT - LABEL_HEIGHT)
 #define WIDGETS_X      ((CONFIG_EATFT_WIDTH - WIDGETS_WIDTH) / 2)
 
+#define WIDGETS_AREA \
+    EATFT_AREA(WIDGETS_X, 0, WIDGETS_WIDTH, CONFIG_EATFT_HEIGHT)
 
 
-static const struct eatft_rect label_rect PROGMEM = {
-    .x = WIDGETS_X,
-    .y = 0,
-    .width = WIDGETS_WIDTH,
-    .height = LABEL_HEIGHT
-};
+static const struct eatft_rect label_rect PROGMEM =
+    EATFT_RECT(EATFT_CUT_TOP(WIDGETS_AREA, LABEL_HEIGHT));
 
-static const struct eatft_rect buttons_rect PROGMEM = {
-    .x = WIDGETS_X,
-    .y = LABEL_HEIGHT,
-    .width = WIDGETS_WIDTH,
-    .height = CONFIG_EATFT_HEIGHT - LABEL_HEIGHT
-};
+static const struct eatft_rect buttons_rect PROGMEM =
+    EATFT_RECT(EATFT_REST_TOP(WIDGETS_AREA, LABEL_HEIGHT, 0));
 
 static void render_label(struct eatft *tft, const char *text)
 {
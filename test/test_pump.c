@@ -0,0 +1,212 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <eatft.h>
+#include <eatft_pump.h>
+
+enum fake_event {
+    FAKE_IDLE = 0,
+    FAKE_COMPLETE,
+    FAKE_TIMEOUT
+};
+
+/* SPI peripheral and display on the other end of the wire */
+struct fake_spi {
+    struct eatft_pump *pump;
+    enum fake_event pending;
+    uint8_t spdr;
+    bool selected;
+
+    /* MOSI bytes and the timer delays started while sending */
+    uint8_t tx[64];
+    int txlen;
+    int gaps;
+    int delays;
+
+    /* answers to the ACK reads */
+    const uint8_t *acks;
+    /* response frame clocked out while receiving */
+    const uint8_t *frame;
+};
+
+static void fake_select(void *hw, bool enable)
+{
+    struct fake_spi *spi = hw;
+    spi->selected = enable;
+}
+
+static void fake_write(void *hw, uint8_t byte)
+{
+    struct fake_spi *spi = hw;
+
+    spi->tx[spi->txlen++] = byte;
+
+    switch (spi->pump->state) {
+    case EATFT_PUMP_ACK:
+        spi->spdr = *spi->acks++;
+        break;
+    case EATFT_PUMP_RECEIVE_HEADER:
+    case EATFT_PUMP_RECEIVE_PAYLOAD:
+        spi->spdr = *spi->frame++;
+        break;
+    default:
+        spi->spdr = 0xff;
+        break;
+    }
+
+    spi->pending = FAKE_COMPLETE;
+}
+
+static void fake_delay(void *hw, uint16_t usec)
+{
+    struct fake_spi *spi = hw;
+
+    /* only slave select and the ACK are guarded by the timer */
+    if (spi->pump->state == EATFT_PUMP_SEND)
+        spi->gaps++;
+    spi->delays++;
+    (void)usec;
+    spi->pending = FAKE_TIMEOUT;
+}
+
+static const struct eatft_pump_ops fake_ops = {
+    .select = fake_select,
+    .write = fake_write,
+    .delay = fake_delay
+};
+
+/* runs the interrupts until the pump goes idle */
+static void fake_run(struct fake_spi *spi)
+{
+    enum fake_event event;
+
+    while ((event = spi->pending) != FAKE_IDLE) {
+        spi->pending = FAKE_IDLE;
+
+        if (event == FAKE_COMPLETE)
+            eatft_pump_complete(spi->pump, spi->spdr);
+        else
+            eatft_pump_timeout(spi->pump);
+    }
+}
+
+static int test_transmit(void)
+{
+    struct eatft tft;
+    struct eatft_pump pump;
+    struct fake_spi spi;
+    const uint8_t acks[] = { EATFT_NAK, EATFT_ACK };
+    const uint8_t packet[] = {
+        EATFT_DC1, 3, 0x1b, 'D', 'L',
+        (EATFT_DC1 + 3 + 0x1b + 'D' + 'L') & 0xff
+    };
+    int failed = 0;
+
+    memset(&spi, 0, sizeof(spi));
+    spi.pump = &pump;
+    spi.acks = acks;
+
+    eatft_init(&tft);
+    eatft_pump_init(&pump, &tft, &fake_ops, &spi);
+
+    eatft_clear(&tft);
+    eatft_flush(&tft);
+    eatft_process(&tft);
+    fake_run(&spi);
+
+    /* the NAK costs a retransmission, each packet is followed by a read */
+    if (spi.txlen != 2 * (sizeof(packet) + 1)
+        || memcmp(spi.tx, packet, sizeof(packet))
+        || spi.tx[sizeof(packet)] != 0x00
+        || memcmp(spi.tx + sizeof(packet) + 1, packet, sizeof(packet))
+        || spi.tx[2 * sizeof(packet) + 1] != 0x00) {
+        fprintf(stderr, "FAIL: transmit sent %d bytes\n", spi.txlen);
+        failed = 1;
+    }
+    /* select and ACK guard per attempt, no timer between bytes */
+    if (spi.gaps != 0 || spi.delays != 2 * 2) {
+        fprintf(stderr, "FAIL: %d timer delays, %d between bytes\n",
+                spi.delays, spi.gaps);
+        failed = 1;
+    }
+    if (pump.state != EATFT_PUMP_READY || spi.selected) {
+        fprintf(stderr, "FAIL: pump busy after the ACK\n");
+        failed = 1;
+    }
+
+    return failed;
+}
+
+static int test_receive(void)
+{
+    struct eatft tft;
+    struct eatft_pump pump;
+    struct fake_spi spi;
+    const uint8_t frame[] = {
+        EATFT_DC1, 4, 0x1b, 'A', 1, 7,
+        (EATFT_DC1 + 4 + 0x1b + 'A' + 1 + 7) & 0xff
+    };
+    int failed = 0;
+
+    memset(&spi, 0, sizeof(spi));
+    spi.pump = &pump;
+    spi.frame = frame;
+
+    eatft_init(&tft);
+    eatft_pump_init(&pump, &tft, &fake_ops, &spi);
+
+    tft.receive(&tft);
+    fake_run(&spi);
+
+    if (tft.ilen != sizeof(frame) || memcmp(tft.ibuf, frame, sizeof(frame))) {
+        fprintf(stderr, "FAIL: received %d bytes\n", tft.ilen);
+        failed = 1;
+    }
+    if (spi.txlen != sizeof(frame)) {
+        fprintf(stderr, "FAIL: %d bytes clocked for the frame\n", spi.txlen);
+        failed = 1;
+    }
+    if (pump.state != EATFT_PUMP_READY || spi.selected) {
+        fprintf(stderr, "FAIL: pump busy after the frame\n");
+        failed = 1;
+    }
+
+    return failed;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    failed |= test_transmit();
+    failed |= test_receive();
+
+    return failed;
+}
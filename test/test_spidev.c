@@ -0,0 +1,119 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#include <eatft.h>
+#include <eatft_spidev.h>
+
+/* what the mock saw of the SPI_IOC_MESSAGE */
+static uint8_t g_tx[64];
+static int g_txlen;
+static int g_messages;
+static int g_acks;
+static bool g_word_delay;
+static bool g_ack_delay;
+
+static int mock_ioctl(int fd, unsigned long request, void *arg)
+{
+    struct spi_ioc_transfer *xfer = arg;
+    int n, i;
+
+    (void)fd;
+
+    /* mode, bits, speed and bit order are all accepted */
+    if (_IOC_TYPE(request) != SPI_IOC_MAGIC || _IOC_NR(request) != 0)
+        return 0;
+
+    n = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+    g_messages++;
+
+    for (i = 0; i < n; i++) {
+        if (xfer[i].tx_buf) {
+            memcpy(g_tx + g_txlen, (void *)(uintptr_t)xfer[i].tx_buf,
+                   xfer[i].len);
+            g_txlen += xfer[i].len;
+
+            if (xfer[i].word_delay_usecs == CONFIG_EATFT_SPI_BYTE_US
+                || xfer[i].delay_usecs >= CONFIG_EATFT_SPI_BYTE_US)
+                g_word_delay = true;
+
+            /* slave select is released for the pause before the ACK */
+            if (xfer[i].cs_change && xfer[i].delay_usecs > 0)
+                g_ack_delay = true;
+        } else if (xfer[i].rx_buf) {
+            *(uint8_t *)(uintptr_t)xfer[i].rx_buf = EATFT_ACK;
+            g_acks++;
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    struct eatft tft;
+    const uint8_t expected[] = {
+        EATFT_DC1, 3, 0x1b, 'D', 'L',
+        (EATFT_DC1 + 3 + 0x1b + 'D' + 'L') & 0xff
+    };
+    int failed = 0;
+
+    if (eatft_spidev_create_fd(&tft, -1, 100000, mock_ioctl) != OK) {
+        fprintf(stderr, "FAIL: create\n");
+        return 1;
+    }
+
+    eatft_clear(&tft);
+    eatft_flush(&tft);
+    eatft_process(&tft);
+
+    if (g_txlen != sizeof(expected) || memcmp(g_tx, expected, g_txlen)) {
+        fprintf(stderr, "FAIL: packet of %d bytes differs\n", g_txlen);
+        failed = 1;
+    }
+    if (g_messages != 1 || g_acks != 1) {
+        fprintf(stderr, "FAIL: %d messages, %d ACK reads\n",
+                g_messages, g_acks);
+        failed = 1;
+    }
+    if (!g_word_delay || !g_ack_delay) {
+        fprintf(stderr, "FAIL: byte or ACK pause missing\n");
+        failed = 1;
+    }
+    if (tft.state != EATFT_RESET) {
+        fprintf(stderr, "FAIL: state %d after the ACK\n", tft.state);
+        failed = 1;
+    }
+
+    eatft_spidev_free(&tft);
+
+    return failed;
+}
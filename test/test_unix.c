@@ -29,6 +29,7 @@
 #include <string.h>
 
 #include <eatft.h>
+#include <eatft_unix.h>
 
 #include "test.h"
 
@@ -65,9 +66,15 @@ int main(int argc, char *argv[])
 
     test_render(&g_tft);
 
+    /* callbacks run from the loop below, not from eatft_process() */
+    eatft_events_defer(&g_tft, true);
+
     for (;;) {
-        usleep(100);
         eatft_process(&g_tft);
+        eatft_events_dispatch(&g_tft);
+
+        /* sleep until the next poll is due */
+        usleep(eatft_poll_next(&g_tft));
     }
 
     unix_free(&g_tft);
@@ -0,0 +1,397 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Encoder benchmark. Every primitive of src/eatft.c is first checked
+ * against its golden bytes, then timed in ns per command and MB/s of
+ * encoded payload. Flushes go through the cost model, so nothing but the
+ * encoder is measured. `-g` prints the bytes the encoder produces now in
+ * the form of the table below.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <eatft.h>
+
+#if CONFIG_EATFT_MARGIN_X != 2 || CONFIG_EATFT_MARGIN_Y != 2
+#  error "golden vectors assume the default margins"
+#endif
+
+static const struct eatft_rect rect = { 10, 20, 100, 40 };
+static const struct eatft_point p1 = { 1, 2 };
+static const struct eatft_point p2 = { 300, 200 };
+
+static void vcreate(struct eatft *tft, bool sw, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    if (sw)
+        eatft_switch_vcreatei(tft, 10, 20, 100, 40, 0x82, 0x02,
+                              EATFT_ALIGN_LEFT, fmt, args);
+    else
+        eatft_button_vcreatei(tft, 10, 20, 100, 40, 0x81, 0x01,
+                              EATFT_ALIGN_CENTER, fmt, args);
+    va_end(args);
+}
+
+/* name, call and the bytes it appends */
+#define PRIMITIVES(X) \
+    X(terminal_enable, (eatft_terminal_enable(tft, false)), \
+      0x1b, 'T', 'A') \
+    X(touch_enable, (eatft_touch_enable(tft, 1)), \
+      0x1b, 'A', 'A', 0x01) \
+    X(touch_beep, (eatft_touch_beep(tft, true)), \
+      0x1b, 'A', 'S', 0x01) \
+    X(touch_draginterval, (eatft_touch_draginterval(tft, 5)), \
+      0x1b, 'A', 'I', 0x05) \
+    X(info, (eatft_info(tft)), \
+      0x1b, 'T', 'I') \
+    X(button_setfont, (eatft_button_setfont(tft, EATFT_FONT_7X12)), \
+      0x1b, 'A', 'F', 0x03) \
+    X(button_setfontzoom, (eatft_button_setfontzoom(tft, 2)), \
+      0x1b, 'A', 'Z', 0x02, 0x02) \
+    X(button_setfontcolor, (eatft_button_setfontcolor(tft, 8, 1)), \
+      0x1b, 'F', 'A', 0x08, 0x01) \
+    X(button_setoffset, (eatft_button_setoffset(tft, 3, 4)), \
+      0x1b, 'A', 'O', 0x03, 0x04) \
+    X(button_setframecolor, \
+      (eatft_button_setframecolor(tft, 1, 2, 3, 4, 5, 6)), \
+      0x1b, 'F', 'E', 0x01, 0x02, 0x03, 0x04, 0x05, 0x06) \
+    X(button_createi, \
+      (eatft_button_createi(tft, 10, 20, 100, 40, 0x81, 0x01, \
+                            EATFT_ALIGN_CENTER, "OK")), \
+      0x1b, 'A', 'T', 0x0c, 0x00, 0x16, 0x00, 0x6a, 0x00, 0x38, \
+      0x00, 0x81, 0x01, 0x43, 0x4f, 0x4b, 0x00) \
+    X(button_vcreatei, (vcreate(tft, false, "%d%%", 42)), \
+      0x1b, 'A', 'T', 0x0c, 0x00, 0x16, 0x00, 0x6a, 0x00, 0x38, \
+      0x00, 0x81, 0x01, 0x43, 0x34, 0x32, 0x25, 0x00) \
+    X(button_setframe, (eatft_button_setframe(tft, 7, 90)), \
+      0x1b, 'A', 'E', 0x07, 0x5a) \
+    X(button_remove, (eatft_button_remove(tft, 3)), \
+      0x1b, 'A', 'L', 0x03, 0x01) \
+    X(button_undefine, (eatft_button_undefine(tft, 3)), \
+      0x1b, 'A', 'L', 0x03, 0x00) \
+    X(switch_createi, \
+      (eatft_switch_createi(tft, 10, 20, 100, 40, 0x82, 0x02, \
+                            EATFT_ALIGN_LEFT, "On")), \
+      0x1b, 'A', 'K', 0x0c, 0x00, 0x16, 0x00, 0x6a, 0x00, 0x38, \
+      0x00, 0x82, 0x02, 0x4c, 0x4f, 0x6e, 0x00) \
+    X(switch_vcreatei, (vcreate(tft, true, "ch %u", 7)), \
+      0x1b, 'A', 'K', 0x0c, 0x00, 0x16, 0x00, 0x6a, 0x00, 0x38, \
+      0x00, 0x82, 0x02, 0x4c, 0x63, 0x68, 0x20, 0x37, 0x00) \
+    X(switch_set, (eatft_switch_set(tft, 0x82, true)), \
+      0x1b, 'A', 'P', 0x82, 0x01) \
+    X(radio_group, (eatft_radio_group(tft, 2)), \
+      0x1b, 'A', 'R', 0x02) \
+    X(touch_areai, (eatft_touch_areai(tft, 10, 20, 100, 40)), \
+      0x1b, 'A', 'H', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(touch_arear, (eatft_touch_arear(tft, &rect)), \
+      0x1b, 'A', 'H', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(touch_area_removei, (eatft_touch_area_removei(tft, 10, 20, 100, 40)), \
+      0x1b, 'A', 'V', 0x3c, 0x00, 0x28, 0x00, 0x01) \
+    X(touch_area_remover, (eatft_touch_area_remover(tft, &rect)), \
+      0x1b, 'A', 'V', 0x3c, 0x00, 0x28, 0x00, 0x01) \
+    X(frame_setcolor, (eatft_frame_setcolor(tft, 1, 2, 3)), \
+      0x1b, 'F', 'R', 0x02, 0x01, 0x03) \
+    X(frame_drawi, (eatft_frame_drawi(tft, 10, 20, 100, 40)), \
+      0x1b, 'R', 'R', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(frame_drawr, (eatft_frame_drawr(tft, &rect)), \
+      0x1b, 'R', 'R', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(rect_drawi, (eatft_rect_drawi(tft, 10, 20, 100, 40)), \
+      0x1b, 'G', 'R', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(rect_drawr, (eatft_rect_drawr(tft, &rect)), \
+      0x1b, 'G', 'R', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(rect_cleari, (eatft_rect_cleari(tft, 10, 20, 100, 40)), \
+      0x1b, 'R', 'L', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(rect_clearr, (eatft_rect_clearr(tft, &rect)), \
+      0x1b, 'R', 'L', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00) \
+    X(rect_filli, (eatft_rect_filli(tft, 10, 20, 100, 40, 3)), \
+      0x1b, 'R', 'F', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00, 0x03) \
+    X(rect_fillr, (eatft_rect_fillr(tft, &rect, 3)), \
+      0x1b, 'R', 'F', 0x0a, 0x00, 0x14, 0x00, 0x6e, 0x00, 0x3c, \
+      0x00, 0x03) \
+    X(line_setwidth, (eatft_line_setwidth(tft, 2)), \
+      0x1b, 'G', 'Z', 0x02, 0x02) \
+    X(line_drawi, (eatft_line_drawi(tft, 1, 2, 300, 200)), \
+      0x1b, 'G', 'D', 0x01, 0x00, 0x02, 0x00, 0x2c, 0x01, 0xc8, \
+      0x00) \
+    X(line_drawp, (eatft_line_drawp(tft, &p1, &p2)), \
+      0x1b, 'G', 'D', 0x01, 0x00, 0x02, 0x00, 0x2c, 0x01, 0xc8, \
+      0x00) \
+    X(bar_setcolor, (eatft_bar_setcolor(tft, 1, 2, 3)), \
+      0x1b, 'F', 'B', 0x01, 0x02, 0x03) \
+    X(bar_createi, \
+      (eatft_bar_createi(tft, 1, EATFT_BAR_UP, 10, 20, 100, 40, \
+                         0, 100, 1)), \
+      0x1b, 'B', 'O', 0x01, 0x0c, 0x00, 0x16, 0x00, 0x6a, 0x00, \
+      0x38, 0x00, 0x00, 0x64, 0x01) \
+    X(bar_set, (eatft_bar_set(tft, 1, 50)), \
+      0x1b, 'B', 'A', 0x01, 0x32) \
+    X(bar_touch, (eatft_bar_touch(tft, 1)), \
+      0x1b, 'A', 'B', 0x01) \
+    X(bar_remove, (eatft_bar_remove(tft, 1)), \
+      0x1b, 'B', 'D', 0x01, 0x01) \
+    X(setfontcolor, (eatft_setfontcolor(tft, 8, 1)), \
+      0x1b, 'F', 'Z', 0x08, 0x01) \
+    X(setfont, (eatft_setfont(tft, EATFT_FONT_6X8)), \
+      0x1b, 'Z', 'F', 0x02) \
+    X(text_draw, (eatft_text_draw(tft, 10, 20, 'C', "Hello")), \
+      0x1b, 'Z', 'C', 0x0a, 0x00, 0x14, 0x00, 0x48, 0x65, 0x6c, \
+      0x6c, 0x6f, 0x00) \
+    X(text_drawi, \
+      (eatft_text_drawi(tft, 10, 20, 100, 40, EATFT_MID_CENTER, "Hello")), \
+      0x1b, 'Z', 'B', 0x0c, 0x00, 0x16, 0x00, 0x6a, 0x00, 0x38, \
+      0x00, 0x05, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x00) \
+    X(text_drawr, \
+      (eatft_text_drawr(tft, &rect, EATFT_MID_LEFT, "%d.%u", -3, 14)), \
+      0x1b, 'Z', 'B', 0x0c, 0x00, 0x16, 0x00, 0x6a, 0x00, 0x38, \
+      0x00, 0x04, 0x2d, 0x33, 0x2e, 0x31, 0x34, 0x00) \
+    X(clear, (eatft_clear(tft)), \
+      0x1b, 'D', 'L') \
+    X(color_set, (eatft_color_set(tft, 1, 8)), \
+      0x1b, 'F', 'D', 0x01, 0x08)
+
+struct primitive {
+    const char *name;
+    void (*run)(struct eatft *tft);
+    const uint8_t *golden;
+    uint8_t len;
+};
+
+#define PRIMITIVE_FUNCTION(name, call, ...) \
+    static void bench_##name(struct eatft *tft) { call; } \
+    static const uint8_t golden_##name[] = { __VA_ARGS__ };
+PRIMITIVES(PRIMITIVE_FUNCTION)
+
+#define PRIMITIVE_ENTRY(name, call, ...) \
+    { #name, bench_##name, golden_##name, sizeof(golden_##name) },
+static const struct primitive primitives[] = {
+    PRIMITIVES(PRIMITIVE_ENTRY)
+};
+
+#define NPRIMITIVES (sizeof(primitives) / sizeof(primitives[0]))
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-c] [-g] [-n iterations] [primitive...]\n"
+            "  -c  check the golden bytes only\n"
+            "  -g  print the bytes of the current encoder\n"
+            "  -n  iterations per primitive, default 1000000\n", name);
+}
+
+static void bench_transmit(struct eatft *tft)
+{
+    (void)tft;
+}
+
+static bool bench_ready(struct eatft *tft)
+{
+    (void)tft;
+    return true;
+}
+
+static void bench_init(struct eatft *tft)
+{
+    memset(tft, 0, sizeof(*tft));
+    tft->transmit = bench_transmit;
+    tft->receive = bench_transmit;
+    tft->ready = bench_ready;
+    eatft_init(tft);
+}
+
+static uint64_t bench_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* the encoded bytes of one call, left in the output buffer */
+static uint8_t encode(struct eatft *tft, const struct primitive *prim)
+{
+    bench_init(tft);
+    prim->run(tft);
+
+    return tft->olen;
+}
+
+static bool check(struct eatft *tft, const struct primitive *prim)
+{
+    uint8_t len = encode(tft, prim);
+    uint8_t i;
+
+    if (len == prim->len && memcmp(tft->obuf, prim->golden, len) == 0)
+        return true;
+
+    printf("%-22s differs from golden bytes\n  got     ", prim->name);
+    for (i = 0; i < len; i++)
+        printf(" %02x", tft->obuf[i]);
+    printf("\n  expected");
+    for (i = 0; i < prim->len; i++)
+        printf(" %02x", prim->golden[i]);
+    printf("\n");
+
+    return false;
+}
+
+static void generate(struct eatft *tft, const struct primitive *prim)
+{
+    uint8_t len = encode(tft, prim);
+    uint8_t i;
+
+    /* the command letters as characters, everything else in hex */
+    printf("%s:\n     ", prim->name);
+    for (i = 0; i < len; i++) {
+        if (i > 0 && i % 10 == 0)
+            printf(" \\\n     ");
+        if (i == 1 || i == 2)
+            printf(" '%c'", tft->obuf[i]);
+        else
+            printf(" 0x%02x", tft->obuf[i]);
+        printf(i + 1 < len ? "," : "\n");
+    }
+}
+
+static void measure(struct eatft *tft, const struct primitive *prim,
+                    uint32_t iterations)
+{
+    struct eatft_cost cost;
+    uint64_t start, ns;
+    uint32_t i;
+
+    bench_init(tft);
+    eatft_cost_begin(tft, &cost);
+
+    start = bench_ns();
+    for (i = 0; i < iterations; i++)
+        prim->run(tft);
+    eatft_flush(tft);
+    ns = bench_ns() - start;
+
+    eatft_cost_end(tft);
+
+    printf("%-22s %3u %10.1f %10.1f\n", prim->name, prim->len,
+           (double)ns / iterations,
+           (double)prim->len * iterations * 1000 / (ns ? ns : 1));
+}
+
+static bool selected(const struct primitive *prim, int argc, char *argv[])
+{
+    int i;
+
+    if (argc == 0)
+        return true;
+
+    for (i = 0; i < argc; i++) {
+        if (strcmp(argv[i], prim->name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct eatft tft;
+    const char *name = argv[0];
+    uint32_t iterations = 1000000;
+    bool checkonly = false;
+    bool gen = false;
+    unsigned failed = 0;
+    unsigned i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "cgn:")) != -1) {
+        switch (opt) {
+        case 'c':
+            checkonly = true;
+            break;
+        case 'g':
+            gen = true;
+            break;
+        case 'n':
+            iterations = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(name);
+            return EXIT_FAILURE;
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (iterations == 0) {
+        usage(name);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < NPRIMITIVES; i++) {
+        if (!selected(&primitives[i], argc, argv))
+            continue;
+
+        if (gen)
+            generate(&tft, &primitives[i]);
+        else if (!check(&tft, &primitives[i]))
+            failed++;
+    }
+
+    if (gen)
+        return EXIT_SUCCESS;
+
+    if (failed) {
+        printf("%u primitives differ, not timed\n", failed);
+        return EXIT_FAILURE;
+    }
+
+    printf("all golden bytes match\n");
+    if (checkonly)
+        return EXIT_SUCCESS;
+
+    printf("\n%-22s %3s %10s %10s\n", "primitive", "len", "ns/cmd", "MB/s");
+    for (i = 0; i < NPRIMITIVES; i++) {
+        if (selected(&primitives[i], argc, argv))
+            measure(&tft, &primitives[i], iterations);
+    }
+
+    return EXIT_SUCCESS;
+}
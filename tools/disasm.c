@@ -0,0 +1,206 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Lists the commands of a capture file or a raw dump of the serial line
+ * and prints where the bytes on the wire go.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <eatft.h>
+#include <eatft_capture.h>
+#include <eatft_disasm.h>
+
+struct listing {
+    bool quiet;
+    uint32_t packet;
+    uint32_t time;
+};
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-q] [-b baud] [-a ack_us] file\n"
+            "  -q  print the profile only\n"
+            "  -b  baud rate for the time share, default 115200\n"
+            "  -a  ACK latency in us, default %u\n",
+            name, CONFIG_EATFT_ACK_US);
+}
+
+static void list_cmd(void *priv, const struct eatft_disasm_cmd *cmd)
+{
+    char line[160];
+
+    (void)priv;
+
+    eatft_disasm_format(cmd, line, sizeof(line));
+    printf("    %s\n", line);
+}
+
+static void list_packet(struct listing *l, struct eatft_profile *prof,
+                        const uint8_t *pkt, size_t size)
+{
+    struct eatft_disasm_info info;
+
+    eatft_profile_packet(prof, pkt, size);
+    l->packet++;
+
+    if (l->quiet)
+        return;
+
+    printf("#%u %10u us %s len %u\n", l->packet, l->time,
+           pkt[0] == EATFT_DC2 ? "DC2" : "DC1", pkt[1]);
+
+    if (eatft_disasm_packet(pkt, size, &info, list_cmd, NULL) != OK)
+        printf("    bad framing\n");
+    else if (!info.bcc_ok)
+        printf("    bad checksum\n");
+
+    if (info.unknown)
+        printf("    %u bytes undecoded\n", info.unknown);
+}
+
+static void list_capture(struct listing *l, struct eatft_profile *prof,
+                         const char *path)
+{
+    struct eatft_capture cap;
+    struct eatft_capture_record rec;
+
+    if (eatft_capture_read_open(&cap, path) != OK) {
+        fprintf(stderr, "%s: not a capture\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    while (eatft_capture_read(&cap, &rec) == OK) {
+        l->time = rec.time;
+
+        switch (rec.type) {
+        case EATFT_CAPTURE_TX:
+            list_packet(l, prof, rec.data, rec.len);
+            break;
+        case EATFT_CAPTURE_NAK:
+            if (!l->quiet)
+                printf(rec.len ? "    NAK\n" : "    ACK timeout\n");
+            break;
+        case EATFT_CAPTURE_RX:
+            if (!l->quiet)
+                printf("    RX %u bytes\n", rec.len);
+            break;
+        }
+    }
+
+    eatft_capture_close(&cap);
+}
+
+/* raw line dumps carry packets back to back with the ACK bytes between */
+static void list_raw(struct listing *l, struct eatft_profile *prof,
+                     FILE *f)
+{
+    uint8_t pkt[258];
+    uint32_t skipped = 0;
+    int c;
+
+    while ((c = fgetc(f)) != EOF) {
+        if (c != EATFT_DC1 && c != EATFT_DC2) {
+            if (c != EATFT_ACK)
+                skipped++;
+            continue;
+        }
+
+        pkt[0] = c;
+        if ((c = fgetc(f)) == EOF)
+            break;
+        pkt[1] = c;
+
+        if (fread(pkt + 2, 1, pkt[1] + 1, f) != (size_t)pkt[1] + 1)
+            break;
+
+        list_packet(l, prof, pkt, pkt[1] + 3);
+    }
+
+    if (skipped)
+        fprintf(stderr, "%u bytes outside of packets skipped\n", skipped);
+}
+
+int main(int argc, char *argv[])
+{
+    struct eatft_profile prof;
+    struct listing l;
+    uint32_t baud = 115200;
+    uint16_t ack_us = CONFIG_EATFT_ACK_US;
+    char magic[4];
+    FILE *f;
+    int opt;
+
+    memset(&l, 0, sizeof(l));
+
+    while ((opt = getopt(argc, argv, "qb:a:")) != -1) {
+        switch (opt) {
+        case 'q':
+            l.quiet = true;
+            break;
+        case 'b':
+            baud = strtoul(optarg, NULL, 0);
+            break;
+        case 'a':
+            ack_us = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 1 || baud == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ((f = fopen(argv[optind], "rb")) == NULL) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    eatft_profile_init(&prof);
+
+    if (fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+        && memcmp(magic, EATFT_CAPTURE_MAGIC, sizeof(magic)) == 0) {
+        fclose(f);
+        list_capture(&l, &prof, argv[optind]);
+    } else {
+        rewind(f);
+        list_raw(&l, &prof, f);
+        fclose(f);
+    }
+
+    if (!l.quiet)
+        printf("\n");
+    eatft_profile_print(&prof, stdout, baud, ack_us);
+
+    return EXIT_SUCCESS;
+}
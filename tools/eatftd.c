@@ -0,0 +1,130 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Display daemon, owns the link to the display and lets several processes
+ * draw on it through shared memory, see eatft_shm.h.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <eatft.h>
+#include <eatft_shm.h>
+#include <eatft_unix.h>
+
+/* client bytes forwarded before the display is served again */
+#define EATFTD_BURST (4 * CONFIG_EATFT_OBUF_SIZE)
+/* dead clients are looked for every that many loops */
+#define EATFTD_REAP_LOOPS 256
+
+static volatile sig_atomic_t g_running = 1;
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-n name] [-s] device\n"
+            "  -n  shared memory name, default %s\n"
+            "  -s  device is a unix domain socket, e.g. of eatft_emu\n",
+            name, EATFT_SHM_NAME);
+}
+
+static void stop(int sig)
+{
+    (void)sig;
+    g_running = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct eatft tft;
+    struct eatft_shm *shm;
+    const char *name = EATFT_SHM_NAME;
+    bool sock = false;
+    uint32_t loops = 0;
+    uint32_t seq;
+    uint16_t taken;
+    int ret;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s")) != -1) {
+        switch (opt) {
+        case 'n':
+            name = optarg;
+            break;
+        case 's':
+            sock = true;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&tft, 0, sizeof(tft));
+
+    ret = sock ? eatft_unix_connect(&tft, argv[optind])
+        : eatft_unix_create(&tft, argv[optind]);
+
+    if (ret != OK || (shm = eatft_shm_server_create(name)) == NULL)
+        return EXIT_FAILURE;
+
+    /* records are routed to the clients instead of dispatched */
+    eatft_events_defer(&tft, true);
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    while (g_running) {
+        seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+
+        taken = eatft_shm_server_forward(shm, &tft, EATFTD_BURST);
+
+        do {
+            eatft_process(&tft);
+        } while (tft.state != EATFT_READY);
+
+        eatft_shm_server_route(shm, &tft);
+
+        if (++loops % EATFTD_REAP_LOOPS == 0)
+            eatft_shm_server_reap(shm, &tft);
+
+        /* sleep until a client submits or the next poll is due */
+        if (taken == 0 && tft.olen == 0)
+            eatft_shm_server_wait(shm, seq, eatft_poll_next(&tft));
+    }
+
+    eatft_shm_server_free(shm, name);
+    eatft_unix_free(&tft);
+
+    return EXIT_SUCCESS;
+}
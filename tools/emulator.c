@@ -0,0 +1,177 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Minimal display emulator for running the library without hardware.
+ * Packets are checked and acknowledged, polls are answered with an empty
+ * send buffer. It listens on a unix domain socket or creates a pty.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <eatft.h>
+
+static unsigned long g_packets;
+static unsigned long g_bytes;
+static unsigned long g_naks;
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s -s socket | -p\n"
+            "  -s  listen on a unix domain socket\n"
+            "  -p  create a pty and print its name\n", name);
+}
+
+static int emu_read(int fd, uint8_t *buf, int len)
+{
+    int done = 0;
+    int n;
+
+    while (done < len && (n = read(fd, buf + done, len - done)) > 0)
+        done += n;
+
+    return done == len ? OK : ERROR;
+}
+
+/* handles one connection until the peer goes away */
+static void emu_serve(int fd)
+{
+    const uint8_t empty[3] = { EATFT_DC1, 0, EATFT_DC1 };
+    uint8_t buf[2 + 255 + 1];
+    uint8_t reply;
+    uint8_t bcc;
+    int i;
+
+    while (emu_read(fd, buf, 2) == OK
+           && emu_read(fd, buf + 2, buf[1] + 1) == OK) {
+
+        for (bcc = 0, i = 0; i < buf[1] + 2; i++)
+            bcc += buf[i];
+
+        if (bcc != buf[buf[1] + 2]
+            || (buf[0] != EATFT_DC1 && buf[0] != EATFT_DC2)) {
+            g_naks++;
+            reply = EATFT_NAK;
+            write(fd, &reply, 1);
+            continue;
+        }
+
+        g_packets++;
+        g_bytes += buf[1] + 3;
+
+        reply = EATFT_ACK;
+        write(fd, &reply, 1);
+
+        /* only the send buffer request is answered */
+        if (buf[0] == EATFT_DC2 && buf[1] == 1 && buf[2] == 'S')
+            write(fd, empty, sizeof(empty));
+    }
+}
+
+static int emu_socket(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+    int client;
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        perror("socket");
+        return ERROR;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(fd, 1) < 0) {
+        perror(path);
+        close(fd);
+        return ERROR;
+    }
+
+    while ((client = accept(fd, NULL, NULL)) >= 0) {
+        emu_serve(client);
+        close(client);
+        printf("%lu packets, %lu bytes, %lu NAKs\n",
+               g_packets, g_bytes, g_naks);
+    }
+
+    close(fd);
+    return OK;
+}
+
+static int emu_pty(void)
+{
+    struct termios tio;
+    int fd;
+
+    if ((fd = posix_openpt(O_RDWR | O_NOCTTY)) < 0
+        || grantpt(fd) < 0
+        || unlockpt(fd) < 0) {
+        perror("pty");
+        return ERROR;
+    }
+
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+
+    printf("%s\n", ptsname(fd));
+    fflush(stdout);
+
+    emu_serve(fd);
+    close(fd);
+
+    printf("%lu packets, %lu bytes, %lu NAKs\n", g_packets, g_bytes, g_naks);
+    return OK;
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:p")) != -1) {
+        switch (opt) {
+        case 's':
+            return emu_socket(optarg) == OK ? EXIT_SUCCESS : EXIT_FAILURE;
+        case 'p':
+            return emu_pty() == OK ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    usage(argv[0]);
+    return EXIT_FAILURE;
+}
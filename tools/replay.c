@@ -0,0 +1,143 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 UVC Ingenieure http://uvc-ingenieure.de/
+ * Author: Max Holtzberg <mholtzberg@uvc-ingenieure.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Replays the transmitted packets of a capture file to a display, either
+ * with the original timing or as fast as the display takes them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <eatft.h>
+#include <eatft_capture.h>
+#include <eatft_unix.h>
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-m] capture device\n"
+            "  -m  replay at maximum speed\n", name);
+}
+
+static void replay_packet(struct eatft *tft,
+                          const struct eatft_capture_record *rec)
+{
+    /* DCx, len, payload and checksum as sent originally */
+    tft->dc = rec->data[0];
+    tft->olen = rec->data[1];
+    memcpy(tft->obuf, rec->data + 2, rec->len - 2);
+
+    tft->state = EATFT_TRANSMIT;
+    tft->next_state = tft->dc == EATFT_DC2 ? EATFT_RECEIVE : EATFT_RESET;
+
+    while (tft->state != EATFT_READY) {
+        eatft_process(tft);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct eatft tft;
+    struct eatft_capture cap;
+    struct eatft_capture_record rec;
+    bool maxspeed = false;
+    bool first = true;
+    bool retry = false;
+    uint32_t start = 0;
+    uint32_t origin = 0;
+    uint32_t elapsed;
+    uint32_t packets = 0;
+    uint32_t bytes = 0;
+    int32_t wait;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m")) != -1) {
+        switch (opt) {
+        case 'm':
+            maxspeed = true;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 2) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&tft, 0, sizeof(tft));
+
+    if (eatft_capture_read_open(&cap, argv[optind]) != OK
+        || eatft_unix_create(&tft, argv[optind + 1]) != OK) {
+        return EXIT_FAILURE;
+    }
+
+    while (eatft_capture_read(&cap, &rec) == OK) {
+        if (rec.type == EATFT_CAPTURE_NAK) {
+            retry = true;
+            continue;
+        }
+
+        if (rec.type != EATFT_CAPTURE_TX
+            || rec.len < 3 || rec.len - 2 > CONFIG_EATFT_OBUF_SIZE)
+            continue;
+
+        /* retransmissions are repeated by the driver on its own */
+        if (retry) {
+            retry = false;
+            continue;
+        }
+
+        if (first) {
+            first = false;
+            origin = rec.time;
+            start = eatft_clock(&tft);
+        } else if (!maxspeed) {
+            wait = (rec.time - origin) - (eatft_clock(&tft) - start);
+            if (wait > 0)
+                usleep(wait);
+        }
+
+        replay_packet(&tft, &rec);
+        packets++;
+        bytes += rec.len;
+    }
+
+    elapsed = eatft_clock(&tft) - start;
+
+    printf("%u packets, %u bytes in %u.%03u s, ACK latency %u us\n",
+           packets, bytes, elapsed / 1000000, elapsed / 1000 % 1000,
+           tft.ack_us);
+
+    eatft_capture_close(&cap);
+    eatft_unix_free(&tft);
+
+    return EXIT_SUCCESS;
+}